@@ -6,12 +6,31 @@
     functionality test of PiorityQueue < T , P >
 
     Copyright 2013, R.C. Lacher
+
+    usage: fpq.x                             interactive
+           fpq.x command-file                batch
+           fpq.x -s command-file             batch, silent: only a summary
+           fpq.x -w trace [command-file]     either of the above, recording
+                                             the queue operations to trace
+           fpq.x -r trace                    replay trace without prompts or
+                                             output, timing each operation
+           fpq.x -b command-file trace       convert text to binary trace
+           fpq.x -t trace command-file       convert binary trace to text
+
+    The binary trace format is described in pqtrace.h.
+
+    A command file is mapped into memory and run by Batch(), which parses
+    it in place and prints through one pqio::Writer; its output is byte for
+    byte what the prompt loop prints for the same commands.
 */
 
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <iomanip>
 #include <cstdlib>
+#include <cstring>
+#include <chrono>
 
 #include <pair.h>      // to make pairs <fsu::String, int>
 #include <compare.h>   // generic lessthan and greaterthan predicates
@@ -19,42 +38,25 @@
 #include <xstring.cpp> // in lieu of makefile
 
 #include <pq.h>
+#include <pqpolicy.h>
+#include <pqtrace.h>
+#include <pqio.h>
 
 typedef fsu::Pair        < int, fsu::String > Widget;
 typedef fsu::LessThan    < Widget >           PredicateType;
 // typedef fsu::GreaterThan < Widget >           PredicateType;
 
- // unordered list with fsu::g_max_element 
-typedef pq1::PriorityQueue < Widget , PredicateType > PriorityQueue;
-const char * implementation = "List, g_max_element()";
-// */
-
-/* // sorted list with MOList::LowerBound
-typedef pq2::PriorityQueue < Widget , PredicateType > PriorityQueue;
-const char * implementation = "MOList, Insert()";
-// */
-
-/* // unordered deque with fsu::g_max_element and XC
-typedef pq3::PriorityQueue < Widget , PredicateType > PriorityQueue;
-const char * implementation = "Deque, g_max_element(), XC";
-// */
+// The implementation is chosen with PQ_POLICY (see pqpolicy.h), e.g.
+//   clang++ -DPQ_POLICY=pqp::Heap ... fpq.cpp
+// The makefile builds fpq1.x .. fpq6.x from this file that way.
+#ifndef PQ_POLICY
+#define PQ_POLICY pqp::UnorderedList
+#endif
 
-/* // unordered deque with fsu::g_max_element and leapfrog copy
-typedef pq4::PriorityQueue < Widget , PredicateType > PriorityQueue;
-const char * implementation = "Deque, g_max_element(), Leapfrog";
-// */
+typedef pqp::PriorityQueue < Widget , PredicateType , PQ_POLICY > PriorityQueue;
+const char * implementation = PriorityQueue::Implementation();
 
-/* // sorted vector with MOVector::LowerBound
-typedef pq5::PriorityQueue < Widget , PredicateType > PriorityQueue;
-const char * implementation = "MOVector, Insert()";
-// */
-
-/* // partially ordered vector with heap algorithms
-typedef pq6::PriorityQueue < Widget , PredicateType > PriorityQueue;
-const char * implementation = "Vector, g_heap";
-// */
-
-void DisplayMenu();
+void DisplayMenu(std::ostream& os = std::cout);
 
 void GetWidget(Widget& w, std::istream& is, bool BATCH )
 {
@@ -82,23 +84,369 @@ void PutWidgetData(const Widget& w)
   std::cout << w.second_;
 }
 
+pqt::Writer * recorder = 0;
+
+void Record(char op, const Widget* w = 0)
+{
+  if (recorder == 0) return;
+  pqt::Command c;
+  c.op_ = op;
+  if (w != 0)
+  {
+    std::ostringstream name;
+    name << w->second_;
+    c.name_ = name.str();
+    c.priority_ = w->first_;
+  }
+  if (!recorder->Write(c))
+  {
+    std::cerr << "** name too long for the trace -- recording stopped\n";
+    delete recorder;
+    recorder = 0;
+  }
+}
+
+int TextToTrace(const char* in, const char* out)
+{
+  std::ifstream ifs(in);
+  std::ofstream ofs(out, std::ios::binary);
+  if (ifs.fail() || ofs.fail())
+  {
+    std::cout << "cannot open " << (ifs.fail() ? in : out) << '\n';
+    return EXIT_FAILURE;
+  }
+  pqt::Writer writer(ofs);
+  pqt::Command c;
+  while (pqt::ReadText(ifs, c))
+    if (!writer.Write(c))
+    {
+      std::cout << "name too long for the trace: " << c.name_.substr(0, 32) << "...\n";
+      return EXIT_FAILURE;
+    }
+  if (c.op_ == '+')
+  {
+    std::string rest;
+    ifs.clear();
+    std::getline(ifs, rest);
+    std::cout << "bad push command in " << in << ": + " << c.name_ << rest << '\n';
+    return EXIT_FAILURE;
+  }
+  return writer.Good() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int TraceToText(const char* in, const char* out)
+{
+  std::ifstream ifs(in, std::ios::binary);
+  std::ofstream ofs(out);
+  pqt::Reader reader(ifs);
+  if (!reader.Good() || ofs.fail())
+  {
+    std::cout << (reader.Good() ? "cannot open " : "not a trace: ") << (reader.Good() ? out : in) << '\n';
+    return EXIT_FAILURE;
+  }
+  pqt::Command c;
+  while (reader.Read(c))
+    pqt::WriteText(ofs, c);
+  if (!reader.Good())
+  {
+    std::cout << "bad record in " << in << '\n';
+    return EXIT_FAILURE;
+  }
+  ofs << "Q\n";
+  return EXIT_SUCCESS;
+}
+
+int Replay(const char* file)
+// load the whole trace first, so that only queue operations are timed
+{
+  std::ifstream ifs(file, std::ios::binary);
+  pqt::Reader reader(ifs);
+  if (!reader.Good())
+  {
+    std::cout << "not a trace: " << file << '\n';
+    return EXIT_FAILURE;
+  }
+  fsu::Vector < char >   op;
+  fsu::Vector < Widget > arg;
+  pqt::Command c;
+  while (reader.Read(c))
+  {
+    Widget w;
+    NullWidget(w);
+    if (c.op_ == '+')
+    {
+      w.first_ = static_cast<int>(c.priority_);
+      w.second_ = c.name_.c_str();
+    }
+    op.PushBack(c.op_);
+    arg.PushBack(w);
+  }
+  if (!reader.Good())
+  {
+    std::cout << "bad record in " << file << '\n';
+    return EXIT_FAILURE;
+  }
+
+  const char   kind[] = "+-FCESD";
+  const char * label[] = { "Push", "Pop", "Front", "Clear", "Empty", "Size", "Dump" };
+  const size_t K = sizeof(label) / sizeof(label[0]);
+  size_t count[K] = { 0 };
+  double total[K] = { 0 }, worst[K] = { 0 };
+  long long checksum = 0;
+  size_t answers = 0;     // keeps Empty() and Size() from being optimized away
+
+  PredicateType p;
+  PriorityQueue Q(p);
+  for (size_t i = 0; i < op.Size(); ++i)
+  {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    switch (op[i])
+    {
+      case '+': Q.Push(arg[i]); break;
+      case '-': if (!Q.Empty()) { checksum += Q.Front().first_; Q.Pop(); } break;
+      case 'F': if (!Q.Empty()) checksum += Q.Front().first_; break;
+      case 'C': Q.Clear(); break;
+      case 'E': answers += Q.Empty(); break;
+      case 'S': answers += Q.Size(); break;
+      default:  break;   // D: no output in replay
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    size_t k = 0;
+    while (k < K - 1 && kind[k] != op[i]) ++k;
+    ++count[k];
+    total[k] += elapsed.count();
+    if (elapsed.count() > worst[k]) worst[k] = elapsed.count();
+  }
+
+  std::cout << "replay of " << file << ": " << op.Size() << " commands\n"
+            << "  Implementation: " << implementation << "\n\n"
+            << "  command      count   total (us)    mean (ns)     max (ns)\n";
+  for (size_t k = 0; k < K; ++k)
+  {
+    if (count[k] == 0) continue;
+    std::cout << "  " << std::setw(7) << std::left << label[k] << std::right
+              << std::setw(10) << count[k]
+              << std::fixed << std::setprecision(1)
+              << std::setw(13) << 1e6 * total[k]
+              << std::setw(13) << 1e9 * total[k] / count[k]
+              << std::setw(13) << 1e9 * worst[k] << '\n';
+  }
+  std::cout << "\n  final size " << Q.Size() << ", checksum " << checksum
+            << " (" << answers << ")\n";
+  return EXIT_SUCCESS;
+}
+
+// batch engine -------------------------------------------------------
+
+bool IsSpace(char c)
+{
+  return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+bool NextChar(const char*& p, const char* e, char& c)
+// as is >> c
+{
+  while (p != e && IsSpace(*p)) ++p;
+  if (p == e) return false;
+  c = *p++;
+  return true;
+}
+
+bool NextToken(const char*& p, const char* e, const char*& b, size_t& n)
+// as is >> s: b points at the token in the buffer
+{
+  while (p != e && IsSpace(*p)) ++p;
+  b = p;
+  while (p != e && !IsSpace(*p)) ++p;
+  n = p - b;
+  return n > 0;
+}
+
+bool NextInt(const char*& p, const char* e, int& v)
+// as is >> v
+{
+  while (p != e && IsSpace(*p)) ++p;
+  bool negative = false;
+  if (p != e && (*p == '-' || *p == '+')) negative = (*p++ == '-');
+  if (p == e || *p < '0' || *p > '9') return false;
+  long long u = 0;
+  while (p != e && *p >= '0' && *p <= '9') u = 10 * u + (*p++ - '0');
+  v = static_cast<int>(negative ? -u : u);
+  return true;
+}
+
+bool Batch(const pqio::MappedFile& file, PriorityQueue& Q, bool verbose)
+// run the command file; true if it ends with X (continue interactively)
+{
+  pqio::Writer out(1);
+  std::ostream os(&out);
+  const char* p = file.Begin();
+  const char* e = file.End();
+  const char* b;
+  size_t n;
+  Widget w;
+  char option = 'q';
+  size_t commands = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  do
+  {
+    if (verbose) out.Put("Enter [command] [string] [priority] ('M' for menu, 'Q' to quit)\n: ");
+    if (!NextChar(p, e, option)) break;
+    ++commands;
+    if (verbose) { out.Put(option); out.Put('\n'); }
+    switch (option)
+    {
+      case '+': case '1':
+	NextToken(p, e, b, n);
+	w.second_ = std::string(b, n).c_str();
+	NextInt(p, e, w.first_);
+	if (verbose)
+	{
+	  out.Put("  enter   string: "); os << w.second_; out.Put('\n');
+	  out.Put("  enter priority: "); out.Put(w.first_); out.Put('\n');
+	}
+	Q.Push(w);
+	Record('+', &w);
+	break;
+
+      case '-': case '2':
+	Record('-');
+	if (!Q.Empty())
+	{
+	  if (verbose)
+	  {
+	    const Widget& f = Q.Front();
+	    out.Put("Popped "); out.Put(f.first_); out.Put(':'); os << f.second_;
+	    out.Put(" from Q\n");
+	  }
+	  Q.Pop();
+	}
+	else if (verbose)
+	  out.Put("Q is empty\n");
+	break;
+
+      case 'f': case 'F':
+	Record('F');
+	if (!Q.Empty())
+	{
+	  const Widget& f = Q.Front();
+	  if (verbose) { out.Put("Front of Q == "); os << f.second_; out.Put('\n'); }
+	}
+	else if (verbose)
+	  out.Put("Q is empty\n");
+	break;
+
+      case 'e': case 'E':
+	Record('E');
+	if (verbose) out.Put(Q.Empty() ? "Q is empty\n" : "Q is not empty\n");
+	break;
+
+      case 's': case 'S':
+	Record('S');
+	if (verbose) { out.Put("Q size is "); out.Put(Q.Size()); out.Put('\n'); }
+	break;
+
+      case 'c': case 'C':
+	Record('C');
+	Q.Clear();
+	if (verbose) out.Put("Q has been cleared\n");
+	break;
+
+      case 'd': case 'D':
+	Record('D');
+	if (verbose) { out.Put("Q contents:\n"); Q.Dump(os, '\n'); }
+	break;
+
+      case 'm': case 'M':
+	if (verbose) DisplayMenu(os);
+	break;
+
+      case 'x': case 'X':
+	if (verbose)
+	{
+	  out.Put("  ** switched to interactive mode **\n");
+	  out.Flush();
+	  return true;
+	}
+	break;
+
+      case 'q': case 'Q':
+	option = 'q';
+	break;
+
+      default:
+	if (verbose) out.Put("** Unrecognized command -- please try again.\n");
+    }
+  }
+  while (option != 'q');
+
+  if (verbose)
+    out.Put("\nHave a nice day.\n");
+  else
+  {
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    os << commands << " commands in " << std::fixed << std::setprecision(6) << elapsed.count()
+       << " s (" << std::setprecision(1) << 1e9 * elapsed.count() / (commands > 0 ? commands : 1)
+       << " ns/command), final size " << Q.Size() << '\n';
+  }
+  return false;
+}
+
 int main(int argc, char* argv[])
 {
+  if (argc > 2 && std::strcmp(argv[1], "-r") == 0)
+    return Replay(argv[2]);
+  if (argc > 3 && std::strcmp(argv[1], "-b") == 0)
+    return TextToTrace(argv[2], argv[3]);
+  if (argc > 3 && std::strcmp(argv[1], "-t") == 0)
+    return TraceToText(argv[2], argv[3]);
+
+  std::ofstream tfs;
+  if (argc > 2 && std::strcmp(argv[1], "-w") == 0)
+  {
+    tfs.open(argv[2], std::ios::binary);
+    if (tfs.fail())
+    {
+      std::cout << "cannot open " << argv[2] << '\n';
+      return EXIT_FAILURE;
+    }
+    recorder = new pqt::Writer(tfs);
+    argc -= 2;
+    argv += 2;
+  }
+
+  bool SILENT = 0;
+  if (argc > 2 && std::strcmp(argv[1], "-s") == 0)
+  {
+    SILENT = 1;
+    --argc;
+    ++argv;
+  }
+
+  PredicateType p;
+  PriorityQueue  Q(p);
+  // PriorityQueue  Q;
+
   std::ifstream ifs;
   std::istream * inptr = &std::cin;
   bool BATCH = 0;
   if (argc > 1)
   {
     BATCH = 1;
-    ifs.open(argv[1]);
-    if (ifs.fail()) return 0;
-    inptr = &ifs;
+    pqio::MappedFile file(argv[1]);
+    if (!file.Good())
+    {
+      delete recorder;
+      return 0;
+    }
+    if (!Batch(file, Q, !SILENT))
+    {
+      delete recorder;
+      return EXIT_SUCCESS;
+    }
   }
   if (!BATCH) DisplayMenu();
-
-  PredicateType p;
-  PriorityQueue  Q(p);
-  // PriorityQueue  Q;
   Widget w;
   char option;
 
@@ -112,9 +460,11 @@ int main(int argc, char* argv[])
       case '+': case '1':  // void Push(T)
 	GetWidget(w, *inptr, BATCH);
 	Q.Push(w);
+	Record('+', &w);
 	break;
 
       case '-': case '2':  // void Pop()
+	Record('-');
 	if (!Q.Empty())
         {
 	  w = Q.Front();
@@ -131,6 +481,7 @@ int main(int argc, char* argv[])
 	break;
 
       case 'f': case 'F':  // T Front()
+	Record('F');
 	if (!Q.Empty())
         {
 	  w = Q.Front();
@@ -145,21 +496,25 @@ int main(int argc, char* argv[])
 	break;
 
       case 'e': case 'E':  // int Empty()
+	Record('E');
 	std::cout << "Q is ";
 	if (!Q.Empty()) std::cout << "not ";
 	std::cout << "empty\n";
 	break;
 
       case 's': case 'S':  // unsigned int Size()
+	Record('S');
 	std::cout << "Q size is " << Q.Size() << '\n';
 	break;
 
       case 'c': case 'C':  // Clear()
+	Record('C');
 	Q.Clear();
 	std::cout << "Q has been cleared\n";
 	break;
 
       case 'd': case 'D':  // display contents of priority queue
+	Record('D');
 	std::cout << "Q contents:\n";
 	Q.Dump(std::cout, '\n');
 	break;
@@ -196,13 +551,14 @@ int main(int argc, char* argv[])
     }
   }
   while (option != 'q');
+  delete recorder;
   std::cout << "\nHave a nice day." << std::endl;
   return EXIT_SUCCESS;
 }
 
-void DisplayMenu()
+void DisplayMenu(std::ostream& os)
 {
-  std::cout << '\n'
+  os << '\n'
 	    << "  PriorityQueue < Pair < int , String > , PredicateType > Q\n"
 	    << "    Implementation: " << implementation << "\n\n"
 	    << "  Push  (string, priority)  ......  + or 1\n"
@@ -0,0 +1,368 @@
+/*
+  hugevec.h
+
+  pqh::Vector < T , F > , pqh::MOVector < T , P , F >
+
+  Array storage for the vector-backed queues that asks the kernel for huge
+  pages and, optionally, for memory on the NUMA node of the calling
+  thread. A heap of many gigabytes in 4 KB pages misses the TLB on nearly
+  every level of every Push and Pop; in 2 MB pages most of those misses
+  go away.
+
+  Vector is a drop-in for fsu::Vector in pq6 and pq19, MOVector for
+  fsu::MOVector in pq5, as their container argument:
+
+    pq6::PriorityQueue < T , P , pqh::Vector < T > >                      q;
+    pq5::PriorityQueue < T , P , pqh::MOVector < T , P > >                s;
+    pq19::PriorityQueue < T , P , 4096 , pqh::Vector < T , pqh::Local > > b;
+
+  or through the policies pqp::HugeHeap < F >, pqp::HugeSortedVector < F >
+  and pqp::HugeBHeap < B , F >, defined here for pqp::PriorityQueue
+  (pqpolicy.h).
+
+  The flags F (default Transparent) choose how the array is mapped:
+    Transparent  anonymous mmap, aligned to 2 MB, with
+                 madvise(MADV_HUGEPAGE): transparent huge pages where the
+                 system allows them ("always" or "madvise" in
+                 /sys/kernel/mm/transparent_hugepage/enabled)
+    Explicit     mmap(MAP_HUGETLB) from the hugetlbfs pool
+                 (/proc/sys/vm/nr_hugepages); if the pool is empty or
+                 missing, Transparent
+    Local        also mbind() the array to the NUMA node of the thread
+                 that maps it (MPOL_PREFERRED: the kernel may still use
+                 another node when that one is full)
+    0            plain anonymous mmap
+  Every step falls back quietly: a kernel without huge pages or NUMA
+  gives an ordinary mapping. GetBacking() tells which one was obtained,
+  GetNode() the node preferred, or -1.
+
+  Capacity grows by doubling, in whole huge pages once F asks for them,
+  so the smallest non-empty vector takes 2 MB of address space (physical
+  memory is still allocated as it is touched): use it for large queues.
+  When the kernel refuses a mapping, std::bad_alloc is thrown, as new
+  would.
+*/
+
+#ifndef _HUGEVEC_H
+#define _HUGEVEC_H
+
+#include <cstddef>
+#include <cstring>
+#include <new>          // placement new, std::bad_alloc
+#include <iostream>
+#include <type_traits>  // std::is_trivially_copyable<>
+#include <unistd.h>     // sysconf(), syscall()
+#include <sys/mman.h>   // mmap(), munmap(), madvise()
+#include <sys/syscall.h>
+#include <pq.h>
+
+namespace pqh
+{
+ enum Flags   { Transparent = 1, Explicit = 2, Local = 4 };
+ enum Backing { Unmapped, Normal, Thp, HugeTlb };
+
+ class Arena
+ {
+ public:
+  static const size_t Huge = size_t(2) << 20;
+
+  static size_t Round (size_t bytes, unsigned flags)
+  // whole huge pages when they are asked for, whole pages otherwise
+  {
+    size_t unit = (flags & (Transparent | Explicit)) ? Huge : Page();
+    return (bytes + unit - 1) / unit * unit;
+  }
+
+  static void* Map (size_t bytes, unsigned flags, Backing& backing, int& node)
+  // bytes: a multiple of Round(); 0 if the kernel refuses
+  {
+    void* p = MAP_FAILED;
+    backing = Normal;
+#ifdef MAP_HUGETLB
+    if (flags & Explicit)
+    {
+      p = ::mmap(0, bytes, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      if (p != MAP_FAILED) backing = HugeTlb;
+    }
+#endif
+    if (p == MAP_FAILED && (flags & (Transparent | Explicit)))
+    {
+      // over-map by one huge page and trim, so that the array starts on
+      // a 2 MB boundary where the kernel can use a huge page from the start
+      char* q = static_cast<char*>(::mmap(0, bytes + Huge, PROT_READ | PROT_WRITE,
+                                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+      if (q != MAP_FAILED)
+      {
+        size_t head = (Huge - reinterpret_cast<size_t>(q) % Huge) % Huge;
+        if (head > 0) ::munmap(q, head);
+        ::munmap(q + head + bytes, Huge - head);
+        p = q + head;
+#ifdef MADV_HUGEPAGE
+        if (::madvise(p, bytes, MADV_HUGEPAGE) == 0) backing = Thp;
+#endif
+      }
+    }
+    if (p == MAP_FAILED)
+      p = ::mmap(0, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED)
+    {
+      backing = Unmapped;
+      return 0;
+    }
+    node = (flags & Local) ? Bind(p, bytes) : -1;
+    return p;
+  }
+
+  static void Unmap (void* p, size_t bytes)
+  {
+    if (p != 0) ::munmap(p, bytes);
+  }
+
+  static int CurrentNode ()
+  // NUMA node of the calling thread; -1 if unknown
+  {
+#ifdef SYS_getcpu
+    unsigned cpu = 0, node = 0;
+    if (::syscall(SYS_getcpu, &cpu, &node, 0) == 0)
+      return static_cast<int>(node);
+#endif
+    return -1;
+  }
+
+ private:
+  static size_t Page ()
+  {
+    static const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    return page;
+  }
+
+  static int Bind (void* p, size_t bytes)
+  // prefer the node of the calling thread for [p, p + bytes)
+  {
+#ifdef SYS_mbind
+    const int preferred = 1;                    // MPOL_PREFERRED
+    int node = CurrentNode();
+    if (node < 0 || node >= 1024) return -1;
+    unsigned long mask[1024 / (8 * sizeof(unsigned long))] = { 0 };
+    mask[node / (8 * sizeof(unsigned long))] = 1UL << (node % (8 * sizeof(unsigned long)));
+    if (::syscall(SYS_mbind, p, bytes, preferred, mask, 1024UL + 1, 0U) == 0)
+      return node;
+#else
+    (void)p; (void)bytes;
+#endif
+    return -1;
+  }
+ };
+
+ template <typename T, unsigned F = Transparent>
+ class Vector
+ {
+ public:
+  typedef T        ValueType;
+  typedef T*       Iterator;
+  typedef const T* ConstIterator;
+
+  Vector() : a_(0), size_(0), capacity_(0), bytes_(0), backing_(Unmapped), node_(-1)
+  {}
+
+  Vector(const Vector& v) : a_(0), size_(0), capacity_(0), bytes_(0), backing_(Unmapped), node_(-1)
+  {
+    Append(v);
+  }
+
+  Vector& operator = (const Vector& v)
+  {
+    if (this != &v)
+    {
+      Clear();
+      Append(v);
+    }
+    return *this;
+  }
+
+  ~Vector()
+  {
+    Clear();
+    Arena::Unmap(a_, bytes_);
+  }
+
+  void PushBack (const T& t)
+  {
+    if (size_ == capacity_)
+    {
+      T copy(t);               // t may live in this vector
+      Grow();
+      new (a_ + size_) T(copy);
+    }
+    else
+      new (a_ + size_) T(t);
+    ++size_;
+  }
+
+  void PopBack ()
+  {
+    a_[--size_].~T();
+  }
+
+  bool SetCapacity (size_t n)
+  // remap to room for n elements (at least); elements beyond n are
+  // removed; false, and no change, if the kernel refuses the mapping
+  {
+    while (size_ > n) PopBack();
+    if (n == 0)
+    {
+      Arena::Unmap(a_, bytes_);
+      a_ = 0;
+      capacity_ = bytes_ = 0;
+      backing_ = Unmapped;
+      node_ = -1;
+      return true;
+    }
+    size_t bytes = Arena::Round(n * sizeof(T), F);
+    if (bytes == bytes_) return true;
+    Backing backing;
+    int node;
+    T* a = static_cast<T*>(Arena::Map(bytes, F, backing, node));
+    if (a == 0) return false;
+    Move(a, a_, size_);
+    Arena::Unmap(a_, bytes_);
+    a_ = a;
+    bytes_ = bytes;
+    capacity_ = bytes / sizeof(T);
+    backing_ = backing;
+    node_ = node;
+    return true;
+  }
+
+  size_t   Capacity () const { return capacity_; }
+  size_t   Size     () const { return size_; }
+  bool     Empty    () const { return size_ == 0; }
+  Backing  GetBacking () const { return backing_; }
+  int      GetNode  () const { return node_; }
+
+  void Clear ()
+  // the mapping is kept; SetCapacity(0) returns it
+  {
+    while (size_ > 0) PopBack();
+  }
+
+  T&       operator [] (size_t i)       { return a_[i]; }
+  const T& operator [] (size_t i) const { return a_[i]; }
+  T&       Front ()                     { return a_[0]; }
+  const T& Front () const               { return a_[0]; }
+  T&       Back  ()                     { return a_[size_ - 1]; }
+  const T& Back  () const               { return a_[size_ - 1]; }
+
+  Iterator      Begin ()       { return a_; }
+  Iterator      End   ()       { return a_ + size_; }
+  ConstIterator Begin () const { return a_; }
+  ConstIterator End   () const { return a_ + size_; }
+
+  void Display (std::ostream& os, char ofc = '\0') const
+  {
+    for (size_t i = 0; i < size_; ++i)
+    {
+      os << a_[i];
+      if (ofc != '\0') os << ofc;
+    }
+  }
+
+ protected:
+  T*       a_;
+  size_t   size_;
+  size_t   capacity_;
+  size_t   bytes_;
+  Backing  backing_;
+  int      node_;
+
+  void Grow ()
+  {
+    if (!SetCapacity(capacity_ == 0 ? 1 : 2 * capacity_))
+      throw std::bad_alloc();
+  }
+
+  void Append (const Vector& v)
+  {
+    if (v.size_ > capacity_ && !SetCapacity(v.size_))
+      throw std::bad_alloc();
+    for (size_t i = 0; i < v.size_; ++i)
+      new (a_ + i) T(v.a_[i]);
+    size_ = v.size_;
+  }
+
+  static void Move (T* to, T* from, size_t n)
+  {
+    if (std::is_trivially_copyable<T>::value)
+    {
+      if (n > 0) std::memcpy(static_cast<void*>(to), from, n * sizeof(T));
+      return;
+    }
+    for (size_t i = 0; i < n; ++i)
+    {
+      new (to + i) T(static_cast<T&&>(from[i]));
+      from[i].~T();
+    }
+  }
+ };
+
+ template <typename T, class P, unsigned F = Transparent>
+ class MOVector : public Vector < T , F >
+ {
+  typedef Vector < T , F > BaseType;
+ public:
+  typedef typename BaseType::Iterator      Iterator;
+  typedef typename BaseType::ConstIterator ConstIterator;
+
+  MOVector() : BaseType(), p_()
+  {}
+
+  Iterator Insert (const T& t)
+  // at the lower bound of t, before the elements equal to it, as
+  // fsu::MOVector::Insert does, so pq5 pops ties in the same order
+  {
+    T copy(t);                 // t may live in this vector
+    size_t lo = 0, hi = this->size_;
+    while (lo < hi)
+    {
+      size_t mid = lo + (hi - lo) / 2;
+      if (p_(this->a_[mid], copy)) lo = mid + 1;
+      else                         hi = mid;
+    }
+    this->PushBack(copy);
+    for (size_t i = this->size_ - 1; i > lo; --i)
+      this->a_[i] = this->a_[i - 1];
+    this->a_[lo] = copy;
+    return this->a_ + lo;
+  }
+
+ private:
+  P p_;
+ };
+} // namespace pqh
+
+namespace pqp
+{
+ template <unsigned F = pqh::Transparent>
+ struct HugeHeap
+ {
+  template <typename T, class P> struct Apply { typedef pq6::PriorityQueue < T , P , pqh::Vector < T , F > > Type; };
+  static const char* Name () { return "Vector, hole sifts, bottom-up pop, huge pages"; }
+ };
+
+ template <unsigned F = pqh::Transparent>
+ struct HugeSortedVector
+ {
+  template <typename T, class P> struct Apply { typedef pq5::PriorityQueue < T , P , pqh::MOVector < T , P , F > > Type; };
+  static const char* Name () { return "MOVector, Insert(), huge pages"; }
+ };
+
+ template <size_t B = 4096, unsigned F = pqh::Transparent>
+ struct HugeBHeap
+ {
+  template <typename T, class P> struct Apply { typedef pq19::PriorityQueue < T , P , B , pqh::Vector < T , F > > Type; };
+  static const char* Name () { return "B-heap, huge pages"; }
+ };
+} // namespace pqp
+
+#endif
@@ -0,0 +1,262 @@
+/*
+  kmerge.h
+
+  km::KWayMerge < I , P >
+  km::PQMerge   < I , P , Q >
+
+  Merge k sorted input ranges [b,e) of iterator type I into one sorted
+  output. "Sorted" means increasing with respect to the predicate P, where
+  p(a,b) == true means a < b (as in pq.h); the merge is stable: equal
+  elements come out in the order of the inputs they were added from.
+  Input iterators only need *, ++ and ==, so an input stream iterator
+  works as a "stream" input.
+
+  KWayMerge is a loser (tournament) tree. Leaf i is input i; each internal
+  node keeps the input that lost the match played there, and loser_[0]
+  keeps the overall winner. After the winner is consumed only its own
+  leaf-to-root path is replayed: ceil(log2 k) comparisons per element and
+  no data movement, where a heap of heads pays a pop and a push. The
+  current head of every input is cached in one contiguous array, so the
+  matches on the path touch key_ and not k scattered input positions.
+
+  PQMerge offers the same interface with the heads kept in any of the
+  pq1 - pq6 PriorityQueue templates, for comparison (Q may have further
+  defaulted container arguments, as pq5 and pq6 do).
+
+  Interface (both classes)
+  ---------
+     void AddRange(b, e)  add input range; before the first Front/Pop
+     bool Empty()         all inputs exhausted
+     const T& Front()     smallest remaining element
+     size_t Source()      index of the input Front() comes from
+     void Pop()           consume Front()
+     O Merge(out)         copy everything that remains to out, in order
+*/
+
+#ifndef _KMERGE_H
+#define _KMERGE_H
+
+#include <cstddef>
+#include <iterator>    // std::iterator_traits<>
+#include <vector.h>    // fsu::Vector<>
+#include <pq.h>
+
+namespace km
+{
+ template <typename I, class P>
+ class KWayMerge
+ {
+ public:
+  typedef typename std::iterator_traits < I > ::value_type ValueType;
+  typedef P                                                PredicateType;
+
+  KWayMerge() : p_(), built_(true)
+  {}
+
+  explicit KWayMerge(P p) : p_(p), built_(true)
+  {}
+
+  void AddRange (I b, I e)
+  {
+    cur_.PushBack(b);
+    end_.PushBack(e);
+    built_ = false;
+  }
+
+  bool Empty () const
+  {
+    Build();
+    return cur_.Size() == 0 || done_[loser_[0]];
+  }
+
+  const ValueType& Front () const
+  {
+    Build();
+    return key_[loser_[0]];
+  }
+
+  size_t Source () const
+  {
+    Build();
+    return loser_[0];
+  }
+
+  void Pop ()
+  // replay the path from the winner's leaf to the root
+  {
+    Build();
+    size_t w = loser_[0];
+    if (++cur_[w] == end_[w])
+      done_[w] = 1;
+    else
+      key_[w] = *cur_[w];
+    for (size_t n = (w + cur_.Size()) / 2; n > 0; n /= 2)
+    {
+      if (Beats(loser_[n], w))
+      {
+        size_t t = loser_[n];
+        loser_[n] = w;
+        w = t;
+      }
+    }
+    loser_[0] = w;
+  }
+
+  template <class O>
+  O Merge (O out)
+  {
+    while (!Empty())
+    {
+      *out = Front();
+      ++out;
+      Pop();
+    }
+    return out;
+  }
+
+ private:
+  P                              p_;
+  mutable fsu::Vector < I >      cur_;
+  fsu::Vector < I >              end_;
+  mutable fsu::Vector < ValueType > key_;   // head of each input
+  mutable fsu::Vector < char >   done_;     // 1 = input exhausted
+  mutable fsu::Vector < size_t > loser_;    // [0] winner, [1..k-1] losers
+  mutable bool                   built_;
+
+  bool Beats (size_t a, size_t b) const
+  // input a ahead of input b; exhausted inputs lose, ties go to lower index
+  {
+    if (done_[a] | done_[b]) return done_[b] && !done_[a];
+    if (p_(key_[a], key_[b])) return true;
+    if (p_(key_[b], key_[a])) return false;
+    return a < b;
+  }
+
+  void Build () const
+  // play the initial tournament: leaves are nodes k .. 2k-1
+  {
+    if (built_) return;
+    built_ = true;
+    size_t k = cur_.Size();
+    key_.SetSize(k);
+    done_.SetSize(k);
+    for (size_t i = 0; i < k; ++i)
+    {
+      done_[i] = (cur_[i] == end_[i]);
+      if (!done_[i]) key_[i] = *cur_[i];
+    }
+    loser_.SetSize(k > 0 ? k : 1);
+    loser_[0] = 0;
+    if (k < 2) return;
+    fsu::Vector < size_t > winner;
+    winner.SetSize(2 * k);
+    for (size_t i = 0; i < k; ++i)
+      winner[k + i] = i;
+    for (size_t n = k - 1; n > 0; --n)
+    {
+      size_t a = winner[2 * n], b = winner[2 * n + 1];
+      if (Beats(b, a))
+      {
+        size_t t = a;
+        a = b;
+        b = t;
+      }
+      winner[n] = a;
+      loser_[n] = b;
+    }
+    loser_[0] = winner[1];
+  }
+ };
+
+ template <typename I, class P, template <typename, class, class...> class Q = pq6::PriorityQueue>
+ class PQMerge
+ {
+ public:
+  typedef typename std::iterator_traits < I > ::value_type ValueType;
+  typedef P                                                PredicateType;
+
+  PQMerge() : q_(HeadPredicate(P()))
+  {}
+
+  explicit PQMerge(P p) : q_(HeadPredicate(p))
+  {}
+
+  void AddRange (I b, I e)
+  {
+    cur_.PushBack(b);
+    end_.PushBack(e);
+    if (b != e)
+      q_.Push(Head(*b, cur_.Size() - 1));
+  }
+
+  bool Empty () const
+  {
+    return q_.Empty();
+  }
+
+  const ValueType& Front () const
+  {
+    return q_.Front().v_;
+  }
+
+  size_t Source () const
+  {
+    return q_.Front().i_;
+  }
+
+  void Pop ()
+  // pop the head, push the next element of the same input
+  {
+    size_t i = q_.Front().i_;
+    q_.Pop();
+    if (++cur_[i] != end_[i])
+      q_.Push(Head(*cur_[i], i));
+  }
+
+  template <class O>
+  O Merge (O out)
+  {
+    while (!Empty())
+    {
+      *out = Front();
+      ++out;
+      Pop();
+    }
+    return out;
+  }
+
+ private:
+  struct Head
+  {
+    ValueType v_;
+    size_t    i_;
+    Head() : v_(), i_(0) {}
+    Head(const ValueType& v, size_t i) : v_(v), i_(i) {}
+    // each input has at most one head in the queue
+    bool operator == (const Head& h) const { return i_ == h.i_; }
+    bool operator != (const Head& h) const { return i_ != h.i_; }
+  };
+
+  class HeadPredicate
+  // reversed: the queue's "largest" head is the smallest value
+  {
+  public:
+    HeadPredicate() : p_() {}
+    explicit HeadPredicate(P p) : p_(p) {}
+    bool operator () (const Head& a, const Head& b) const
+    {
+      if (p_(b.v_, a.v_)) return true;
+      if (p_(a.v_, b.v_)) return false;
+      return a.i_ > b.i_;
+    }
+  private:
+    P p_;
+  };
+
+  fsu::Vector < I >                 cur_;
+  fsu::Vector < I >                 end_;
+  Q < Head , HeadPredicate >        q_;
+ };
+} // namespace km
+
+#endif
@@ -13,12 +13,124 @@
   pq3   no   Deque     unordered     fsu::g_max_element()   AO(1)    O(n)      O(n)
   pq4   yes  Deque     unordered     fsu::g_max_element()   AO(1)    O(n)      O(n)
   pq5   yes  MOVector  sorted        MOVector::Insert()     O(n)     O(1)      O(1)
-  pq6   no   Vector    heap          fsu::g_push/pop_heap() O(log n) O(log n)  O(1)
+  pq6   no   Vector    heap          hole-based sifts       O(log n) O(log n)  O(1)
+  pq7   yes  Deque[N]  bucket/level  bitmap + clz           O(1)     O(1)      O(1)
+  pq8   yes  List[]    calendar      year/day bucket scan   EO(1)    EO(1)     EO(1)
+  pq9   no   Vector[]  sequence heap k-way merge of runs      AO(log n) AO(log n) O(log n)
+  pq10  no   Vector    d-ary heap    sift up/down, D kids   O(log n) O(D log n) O(1)
+  pq11  no   Vector x2 heap of keys  (key,slot) heap + slots O(log n) O(log n)  O(1)
+  pq12  no   T[N]      heap          inline array, no alloc O(log n) O(log n)  O(1)
+  pq13  no   Vector    sorted | heap  migrate on size, pops  O(n)|O(log n) O(1)|O(log n) O(1)
+  pq14  no   Vector+bits weak heap   join, reverse bits     O(log n) O(log n)  O(1)
+  pq15  no   nodes     leftist heap  persistent, shared     O(log n) O(log n)  O(1)
+  pq16  no   Vector    interval heap min and max ends         O(log n) O(log n)  O(1)
+  pq17  no   Vector    min-max heap  min and max levels     O(log n) O(log n)  O(1)
+  pq18  no   bitmaps   bit trie      32-bit int keys, 64-way O(log log U) O(log log U) O(1)
+  pq19  no   Vector    B-heap        page-blocked layout    O(log n) O(log n)  O(1)
 
   The pq3 version just copies the last element over the element
   to be removed, whereas the pq4 version does a leapfrog copy. Note that the
   leapfrog copy version is stable, the 1-element copy version is not.
 
+  pq7 is not a comparison queue: its second template argument K maps an
+  element to an integer level in [0,N), and elements are popped from the
+  highest non-empty level, FIFO within a level.
+
+  pq8 is a calendar queue for event lists: K maps an element to its event
+  time (a double) and the element with the *earliest* time is at the front,
+  FIFO among equal times. EO(1) = expected O(1) for a roughly stationary
+  distribution of event times.
+
+  pq9 is Sanders' sequence heap, simplified to one buffer per group: a
+  small insertion heap is flushed as a sorted run into group 0; a full
+  group of K runs is merged into a single run of the next group; each group
+  keeps a buffer of its M largest elements. Almost all element movement is
+  sequential merging, so it stays cache friendly at very large sizes.
+
+  pq11 separates keys from payloads: K extracts a (small) key from an
+  element and P orders keys. The heap holds only (key, slot) pairs; the
+  elements themselves sit in a slot array and are not moved by the sifts,
+  so a sift copies a few bytes per level however large T is. The slot
+  array is an fsu::Vector, though: a Push that grows it moves every
+  element, so a reference from Front() does not survive a Push.
+
+  pq12::StaticPriorityQueue < T , P , N > holds at most N elements in an
+  array inside the object: no allocation ever, and every operation is
+  constexpr (C++14), so a queue of a literal type T with a constexpr
+  predicate can be built and used in constant expressions. TryPush(t)
+  returns false when the queue is full; Push(t) asserts that it is not.
+
+  pq13 adapts its representation to the workload. It starts as a sorted
+  vector (like pq5: O(1) Pop, cheap Push while small) and migrates to a
+  heap (like pq6) when it grows past SortedMax, and back when it shrinks
+  below HeapMin or when a window of operations is dominated by pops (at
+  least PopHeavy of them) while the size is at most SortedMax. Decisions
+  are taken every Window operations, or at once when a sorted queue grows
+  past 2 * SortedMax; the thresholds can be set with SetThresholds(), and
+  GetStatistics() reports the migrations and operation counts.
+
+  pq14 is a weak heap: an array plus one reverse bit per element. It does
+  fewer comparisons than any other heap here: O(1) on average per Push,
+  at most ceil(log2 n) per Pop (about n log n - n to pop everything), and
+  n - 1 to build; choose it when comparing elements is the expensive part.
+
+  pq15 is a persistent leftist heap: copies share their nodes, so copying
+  a queue is O(1) and a copy is an independent snapshot. Push and Pop
+  change only nodes no other copy holds and copy the O(log n) shared
+  nodes they would touch. Take snapshots as often as needed (speculative
+  planning, undo) without paying for pq6's O(n) vector copy; each Push
+  pays an allocation instead.
+
+    pq15::PriorityQueue < T , P > plan = q;   // O(1)
+
+  pq16 (interval heap) and pq17 (min-max heap) are double-ended: besides
+  Front() and Pop() for the largest they have FrontMin() and PopMin() for
+  the smallest, all four O(log n) or better, for a queue that serves from
+  the top and sheds from the bottom. pq16 keeps a min heap and a max heap
+  in one array of intervals and is the faster of the two. pq5 also has
+  FrontMin() and PopMin(), in amortized O(1), but its Push stays O(n).
+
+  pq18 is for integer keys of at most 32 bits: a van Emde Boas style
+  trie of 64-way bitmaps, so that Push, Pop, Erase(k), Successor(k) and
+  Predecessor(k) are a few count-zeros each, O(log log U), independent
+  of n, with duplicates counted. Memory grows by blocks of 4096 keys, so
+  it suits keys dense somewhere (ids, deadlines, the int keys of the
+  sort tests); keys scattered over all 2^32 values are better in pq6. P
+  must order the keys as < or as > does, which the constructor asserts;
+  with > the keys are stored complemented, so that Front() is still the
+  largest under P.
+
+  pq19 is pq6 in a B-heap layout: each page of B bytes (4096 by default)
+  holds a small complete subtree, so that a path from the root to a leaf
+  touches about log n / log(B / sizeof(T)) pages instead of log n. For
+  heaps of millions of elements that no longer fit the TLB, Push and Pop
+  fault and miss far less; for small heaps pq6 is as fast and simpler.
+
+  pq5, pq6 and pq19 take their container as a last, defaulted template
+  argument. pqh::Vector and pqh::MOVector (hugevec.h) map it from huge
+  pages (transparent, or hugetlbfs with pqh::Explicit) and with
+  pqh::Local on the NUMA node of the thread that grows it, falling back
+  to plain pages where the kernel says no:
+
+    pq6::PriorityQueue < T , P , pqh::Vector < T , pqh::Transparent | pqh::Local > > q;
+
+  Every implementation has Merge(other), which moves all elements of an
+  rvalue queue of the same type into *this and leaves other empty, at
+  less cost than popping one queue into the other: append for the
+  unordered ones (pq1, pq3, pq4), a sorted merge for pq2 and pq5, append
+  and an O(n) bottom-up rebuild for pq6, pq10 and pq14 when other is
+  large, level-by-level append for pq7, and an O(log n) meld for pq15.
+  pq12 moves only what fits and returns false if anything stayed behind.
+
+    q.Merge(std::move(shard));
+
+  The array-backed queues pq3 - pq6 also control their capacity, all
+  through pqc::Resizable: Reserve(n) makes room for n elements at once (no
+  doubling during warm-up), Capacity() reports it, ShrinkToFit() returns
+  the memory beyond Size(), SetGrowth(f) grows a full container by the
+  factor f instead of the container's own rule, and SetShrink(r) cuts the
+  capacity to 2 * Size() whenever a Pop leaves less than r of it in use.
+
 All of the pq namespaces are defined in this file.
 
 Concept of Priority Queue (Lacher, 2015)
@@ -77,6 +189,14 @@ pq6
 ---
 A heap is a partially ordered complete binary tree(POT) stored in a vector. Note that
 the largest element( v[0] ) in a heap is the root of the binary tree representation.
+pq6 does its own sifts rather than calling g_push_heap()/g_pop_heap(): a
+"hole" moves through the tree with one assignment per level instead of an XC,
+and Pop is Floyd's bottom-up version (down to a leaf along the larger
+children, then up), with the larger child chosen without a branch. With
+distinct keys the heap layout, and so Dump(), is what g_pop_heap()
+produces; with equal keys it may not be (the sift up stops below an equal
+parent where g_pop_heap() stops above an equal child), though both are
+valid heaps and Pop returns the same sequence of priorities.
 
 
 
@@ -85,6 +205,13 @@ six PriorityQueue implementations because they don't contain pointers.
 
 */
 
+#ifndef _PQ_H
+#define _PQ_H
+
+#include <cmath>       // std::floor()
+#include <cassert>     // assert()
+#include <utility>     // std::declval(), std::swap()
+#include <type_traits> // std::decay<>
 #include <genalg.h>    // fsu::g_max_element()
 #include <gheap.h>     // fsu::g_push_heap()    ,  fsu::g_pop_heap()
 #include <list.h>      // fsu::List<>     ,  fsu::List<>::Iterator
@@ -93,6 +220,94 @@ six PriorityQueue implementations because they don't contain pointers.
 #include <olist.h>     // fsu::MOList<>   ,  fsu::MOList<>::Iterator
 #include <ovector.h>   // fsu::MOVector<> ,  fsu::MOVector<>::Iterator
 
+
+namespace pqc
+{
+ // capacity control for the array-backed queues (pq3 - pq6); C is the
+ // container, with Size(), Capacity() and SetCapacity()
+ class Growth
+ {
+ public:
+  Growth() : factor_(0), shrink_(0)
+  {}
+
+  void SetGrowth (double factor)
+  // a full container grows to factor * Capacity(); 0 = the container's own
+  {
+    factor_ = factor;
+  }
+
+  void SetShrink (double fraction)
+  // after a Pop leaves Size() < fraction * Capacity(), the capacity is cut
+  // to 2 * Size(); 0 = never (fraction < 0.5 avoids grow/shrink cycles)
+  {
+    shrink_ = fraction;
+  }
+
+  double GetGrowth () const { return factor_; }
+  double GetShrink () const { return shrink_; }
+
+  template <class C>
+  void BeforePush (C& c) const
+  {
+    if (factor_ > 1 && c.Size() == c.Capacity())
+    {
+      size_t n = static_cast<size_t>(factor_ * c.Capacity());
+      c.SetCapacity(n > c.Size() ? n : c.Size() + 1);
+    }
+  }
+
+  template <class C>
+  void AfterPop (C& c) const
+  {
+    if (shrink_ > 0 && c.Size() < shrink_ * c.Capacity())
+      c.SetCapacity(2 * c.Size());
+  }
+
+ private:
+  double factor_;
+  double shrink_;
+ };
+ // Reserve, Capacity, ShrinkToFit, SetGrowth and SetShrink, the same for
+ // each of pq3 - pq6: Q derives from Resizable < Q > and befriends it, and
+ // has the container c_ and the Growth grow_
+ template <class Q>
+ class Resizable
+ {
+ public:
+  void Reserve (size_t n)
+  // room for n elements without reallocation
+  {
+    if (n > Self().c_.Capacity()) Self().c_.SetCapacity(n);
+  }
+
+  size_t Capacity () const
+  {
+    return Self().c_.Capacity();
+  }
+
+  void ShrinkToFit ()
+  // give back the memory beyond Size()
+  {
+    Self().c_.SetCapacity(Self().c_.Size());
+  }
+
+  void SetGrowth (double factor)
+  {
+    Self().grow_.SetGrowth(factor);
+  }
+
+  void SetShrink (double fraction)
+  {
+    Self().grow_.SetShrink(fraction);
+  }
+
+ private:
+  Q&       Self ()       { return static_cast<Q&>(*this); }
+  const Q& Self () const { return static_cast<const Q&>(*this); }
+ };
+} // namespace pqc
+
 namespace pq1
 {
   
@@ -129,7 +344,7 @@ namespace pq1
     {
       typedef typename ContainerType::Iterator IteratorType;
       IteratorType i = fsu::g_max_element(c_.Begin(), c_.End(), p_);
-      c_.Remove(*i);
+      c_.Remove(i);   // Remove(*i) would remove every copy of a duplicate
     }
 
     const T& Front () const
@@ -140,6 +355,16 @@ namespace pq1
       return *i;
     }
 
+    void Merge (PriorityQueue&& other)
+    // O(m): append the other list; other is left empty
+    {
+      if (&other == this) return;
+      typedef typename ContainerType::ConstIterator IteratorType;
+      for (IteratorType i = other.c_.Begin(); i != other.c_.End(); ++i)
+        c_.PushBack(*i);
+      other.c_.Clear();
+    }
+
     void Clear ()
     {
       c_.Clear();
@@ -213,6 +438,28 @@ namespace pq2
     return c_.Back();
   }
 
+  void Merge (PriorityQueue&& other)
+  // O(n + m): sorted merge of the two lists into a new one, appended in
+  // increasing order with PushBack, which keeps it ordered without the
+  // search of Insert; on ties the elements of other go in first, further
+  // from the back, so that Pop takes the elements of *this before them, as
+  // if other's had been pushed later; other is left empty
+  {
+    if (&other == this) return;
+    typedef typename ContainerType::ConstIterator IteratorType;
+    ContainerType c;
+    IteratorType i = c_.Begin(), j = other.c_.Begin();
+    while (i != c_.End() && j != other.c_.End())
+    {
+      if (!p_(*i, *j)) { c.PushBack(*j); ++j; }
+      else             { c.PushBack(*i); ++i; }
+    }
+    for (; i != c_.End(); ++i) c.PushBack(*i);
+    for (; j != other.c_.End(); ++j) c.PushBack(*j);
+    std::swap(c_, c);
+    other.c_.Clear();
+  }
+
   void Clear ()
   {
     c_.Clear();
@@ -244,7 +491,7 @@ namespace pq3
 {
 
  template <typename T, class P >
- class PriorityQueue
+ class PriorityQueue : public pqc::Resizable < PriorityQueue < T , P > >
  {
   typedef typename fsu::Deque < T >              ContainerType;
   typedef T                                      ValueType;
@@ -268,6 +515,9 @@ namespace pq3
 
   PredicateType  p_;
   ContainerType  c_;
+  pqc::Growth    grow_;
+
+  friend class pqc::Resizable < PriorityQueue >;
 
  public:
   PriorityQueue() : p_(), c_()
@@ -279,6 +529,7 @@ namespace pq3
   void Push (const T& t)
   // Amortized O(1)
   {
+    grow_.BeforePush(c_);
     c_.PushBack(t);
   }
 
@@ -293,6 +544,7 @@ namespace pq3
       fsu::Swap(*i, c_.Back());
     }
     c_.PopBack();
+    grow_.AfterPop(c_);
   }
 
   const T& Front () const
@@ -303,6 +555,17 @@ namespace pq3
     return *i;
   }
 
+  void Merge (PriorityQueue&& other)
+  // O(m): append the other deque; other is left empty
+  {
+    if (&other == this) return;
+    this->Reserve(c_.Size() + other.c_.Size());
+    typedef typename ContainerType::ConstIterator IteratorType;
+    for (IteratorType i = other.c_.Begin(); i != other.c_.End(); ++i)
+      c_.PushBack(*i);
+    other.c_.Clear();
+  }
+
   void Clear ()
   {
     c_.Clear();
@@ -335,7 +598,7 @@ namespace pq4
 {
 
  template <typename T, class P >
- class PriorityQueue
+ class PriorityQueue : public pqc::Resizable < PriorityQueue < T , P > >
  {
     
   typedef typename fsu::Deque < T >              ContainerType;
@@ -360,6 +623,9 @@ namespace pq4
 
   PredicateType  p_;
   ContainerType  c_;
+  pqc::Growth    grow_;
+
+  friend class pqc::Resizable < PriorityQueue >;
 
  public:
   PriorityQueue() : p_(), c_()
@@ -370,6 +636,7 @@ namespace pq4
 
   void Push (const T& t)
   {
+    grow_.BeforePush(c_);
     c_.PushBack(t);
   }
 
@@ -380,9 +647,13 @@ namespace pq4
     IteratorType i = fsu::g_max_element(c_.Begin(), c_.End(), p_);
     while(*i != c_.Back())
     {
-      fsu::Swap(*i, *(++i));
+      IteratorType j = i;
+      ++j;
+      fsu::Swap(*i, *j);
+      i = j;
     }
     c_.PopBack();
+    grow_.AfterPop(c_);
   }
 
   const T& Front () const
@@ -392,6 +663,18 @@ namespace pq4
     return *i;
   }
 
+  void Merge (PriorityQueue&& other)
+  // O(m): append the other deque; elements of other follow those of
+  // *this, as if pushed later, so the queue stays stable; other is left empty
+  {
+    if (&other == this) return;
+    this->Reserve(c_.Size() + other.c_.Size());
+    typedef typename ContainerType::ConstIterator IteratorType;
+    for (IteratorType i = other.c_.Begin(); i != other.c_.End(); ++i)
+      c_.PushBack(*i);
+    other.c_.Clear();
+  }
+
   void Clear ()
   {
     c_.Clear();
@@ -422,11 +705,11 @@ namespace pq4
 namespace pq5
 {
 
- template <typename T, class P >
- class PriorityQueue
+ template <typename T, class P, class C = fsu::MOVector < T , P > >
+ class PriorityQueue : public pqc::Resizable < PriorityQueue < T , P , C > >
  {
     
-  typedef typename fsu::MOVector < T , P >       ContainerType;
+  typedef C                                      ContainerType;
   typedef T                                      ValueType;
   typedef P                                      PredicateType;
 
@@ -435,25 +718,61 @@ namespace pq5
   // Push(t): use MOVector::Insert(t)
   // Front(): return back element of vector
   // Pop()  : remove element from vector
+  // FrontMin(), PopMin(): the smallest; PopMin only advances lo_ past it,
+  //          and shifts the rest down in place once half the vector is
+  //          taken; the whole vector stays sorted, so Push inserts as
+  //          before, or reuses the slot at lo_ - 1 for a new smallest
 
   PredicateType  p_;
   ContainerType  c_;
+  size_t         lo_;    // c_[0 .. lo_) are taken by PopMin
+  pqc::Growth    grow_;
+
+  friend class pqc::Resizable < PriorityQueue >;
+
+  void Compact ()
+  // O(n - lo_): drop the elements taken by PopMin, shifting the rest down
+  {
+    if (lo_ == 0) return;
+    size_t n = c_.Size() - lo_;
+    for (size_t i = 0; i < n; ++i)
+      c_[i] = c_[lo_ + i];
+    for (; lo_ > 0; --lo_)
+      c_.PopBack();
+  }
 
 public:
-  PriorityQueue() : p_(), c_()
+  PriorityQueue() : p_(), c_(), lo_(0)
   {}
 
-  explicit PriorityQueue(P p) : p_(p), c_()
+  explicit PriorityQueue(P p) : p_(p), c_(), lo_(0)
   {}
 
   void Push (const T& t)
+  // O(n); O(1) for a new smallest while PopMin has left room below it
   {
+    if (lo_ > 0)
+    {
+      if (p_(t, c_[lo_ - 1]))
+        Compact();                  // t belongs among the elements taken
+      else if (p_(t, c_[lo_]))
+      {
+        c_[--lo_] = t;
+        return;
+      }
+      else if (!p_(c_[lo_ - 1], t))
+        Compact();                  // t ties c_[lo_ - 1]: Insert, which goes
+                                    // before its equals, would land below lo_
+    }
+    grow_.BeforePush(c_);
     c_.Insert(t);
   }
 
   void Pop ()
   {
     c_.PopBack();
+    if (c_.Size() == lo_) Clear();
+    grow_.AfterPop(c_);
   }
 
   const T& Front () const
@@ -461,9 +780,55 @@ public:
     return c_.Back();
   }
 
+  void PopMin ()
+  // amortized O(1): the shift of Compact is paid for by the lo_ PopMins
+  // before it
+  {
+    if (++lo_ == c_.Size())
+      Clear();
+    else if (2 * lo_ >= c_.Size())
+      Compact();
+    grow_.AfterPop(c_);
+  }
+
+  const T& FrontMin () const
+  // O(1)
+  {
+    return c_[lo_];
+  }
+
+  void Merge (PriorityQueue&& other)
+  // O(n + m): grow the vector by m, then merge the two from the back into
+  // place; on ties the elements of *this go nearer the back, so that Pop
+  // takes them before those of other, as if other's had been pushed
+  // later; other is left empty
+  {
+    if (&other == this) return;
+    Compact();
+    other.Compact();
+    size_t i = c_.Size(), j = other.c_.Size(), k = i + j;
+    this->Reserve(k);
+    for (size_t n = 0; n < j; ++n)
+      c_.PushBack(other.c_[n]);                 // room, overwritten below
+    while (j > 0)
+    {
+      if (i > 0 && !p_(c_[i - 1], other.c_[j - 1])) c_[--k] = c_[--i];
+      else                                           c_[--k] = other.c_[--j];
+    }
+    other.Clear();
+  }
+
+  void ShrinkToFit ()
+  // give back the memory beyond Size(), the elements taken by PopMin too
+  {
+    Compact();
+    c_.SetCapacity(c_.Size());
+  }
+
   void Clear ()
   {
     c_.Clear();
+    lo_ = 0;
   }
 
   bool Empty () const
@@ -473,7 +838,7 @@ public:
 
   size_t Size () const
   {
-    return c_.Size();
+    return c_.Size() - lo_;
   }
 
   const P& GetPredicate() const
@@ -481,31 +846,84 @@ public:
     return p_;
   }
 
+  const C& GetContainer() const
+  // the container itself, to inspect (its backing, for a pqh::Vector)
+  {
+    return c_;
+  }
+
   void Dump (std::ostream& os, char ofc = '\0') const
   {
-    c_.Display(os,ofc);
+    if (lo_ == 0)
+    {
+      c_.Display(os,ofc);
+      return;
+    }
+    for (size_t i = lo_; i < c_.Size(); ++i)
+    {
+      os << c_[i];
+      if (ofc != '\0') os << ofc;
+    }
   }
  };
 } // namespace pq5
 
 namespace pq6
 {
- template <typename T, class P >
- class PriorityQueue
+ template <typename T, class P, class C = fsu::Vector < T > >
+ class PriorityQueue : public pqc::Resizable < PriorityQueue < T , P , C > >
  {
     
-  typedef typename fsu::Vector < T >               ContainerType;
+  typedef C                                        ContainerType;
   typedef T                                        ValueType;
   typedef P                                        PredicateType;
 
   // store elements in partial order using heap algorithms
   // first element(root) is largest
-  // Push(t): c_.PushBack(t) followed by g_push_heap()
+  // Push(t): c_.PushBack(t) followed by a hole-based sift up
   // Front(): c_.Front()  ( v[0] )
-  // Pop()  : g_pop_heap() followed by c_.PopBack()
+  // Pop()  : bottom-up (Floyd) sift of the last leaf, then c_.PopBack()
 
   PredicateType  p_;
   ContainerType  c_;
+  pqc::Growth    grow_;
+
+  friend class pqc::Resizable < PriorityQueue >;
+
+  void SiftUp (size_t c)
+  // move c_[c] up to its place, one assignment per level (see Push)
+  {
+    T t = c_[c];
+    while (c > 0)
+    {
+      size_t p = (c - 1) / 2;
+      if (!p_(c_[p], t))
+        break;
+      c_[c] = c_[p];
+      c = p;
+    }
+    c_[c] = t;
+  }
+
+  void Heapify ()
+  // Floyd: sift every parent down, last parent first; O(size)
+  {
+    size_t n = c_.Size();
+    for (size_t i = n / 2; i > 0; --i)
+    {
+      T t = c_[i - 1];
+      size_t p = i - 1;
+      for (size_t c = 2 * p + 1; c < n; c = 2 * p + 1)
+      {
+        if (c + 1 < n && p_(c_[c], c_[c + 1])) ++c;
+        if (!p_(t, c_[c]))
+          break;
+        c_[p] = c_[c];
+        p = c;
+      }
+      c_[p] = t;
+    }
+  }
 
  public:
   PriorityQueue() : p_(), c_()
@@ -516,67 +934,109 @@ namespace pq6
 
   void Push(const T& t)
   /*
-    Description of Push Heap Algorithm (Lacher, 2015)
+    Push with a "hole" (Lacher's Push Heap Algorithm, without the swaps)
     Action                 Vector Pseudocode     Comment
     ------                 -----------------     -------
-[1] Add data at next leaf  v.push_back(t);       size increased by 1
-[2] Repair upward          c = size - 1          v[c] is the new leaf added above
-[3] (Repeat)               do {
-    locate parent            p = (c - 1)/ 2;     v[p] = parent of v[c]
-    if POT not satisfied     if(v[c] > v[p])     parent/child in wrong order 
-      swap                     XC(v[c],v[p]);    exchange values between parent, child
-                               c = p;            reset child
+[1] Open a hole at the     v.push_back(t);       size increased by 1
+    next leaf              c = size - 1          v[c] is the hole
+[2] Move the hole up       while (c > 0) {
+    locate parent            p = (c - 1)/ 2;     v[p] = parent of the hole
+    if POT not satisfied     if (v[p] < t)       parent smaller than t
+      move parent down         v[c] = v[p];      one assignment, not an XC
+                               c = p;            hole moves up
     else                     else
-      stop                     finished = true;  POT property is restored
-    Until POT               } until finished;    nothing left to do
+      stop                     break;            t belongs in the hole
+                           }
+[3] Fill the hole          v[c] = t;
 
-[1] is an O(1) operation
-[2], [3] is O(log size)      
+[1], [3] are O(1)
+[2] is O(log size), one comparison and one assignment per level
    */
-  
   {
+    grow_.BeforePush(c_);
     c_.PushBack(t);
-    g_push_heap(c_.Begin(), c_.End(), p_);
-    
+    SiftUp(c_.Size() - 1);
   }
 
   void Pop()
   /*
+    Pop bottom-up (Floyd): the last leaf nearly always belongs near the
+    bottom again, so descend to a leaf without comparing against it, then
+    sift it up from there
     Action                              Vector Pseudocode       Comment
     ------                              -----------------       -------
-[1] Copy last leaf to root              v[0] = v[size - 1];     new root value
-    (Alternative) XC last leaf and root  XC(v[0],v[size - 1]);  new root value,
-    old root value saved
-[2] Remove last leaf                    v.pop_back();           size is reduced by 1
-    (Alternative) decrement size        --size;                 range is reduced by 1
-[3] Repair downward                     p = 0;                  initialize p = root
-    Repeat                              do {
-    Identify children                     l = 2*p + 1;          v[l] = left child of v[p]
-                                          r = l + 1;            v[r] = right child of v[p]
-    Find larger child                     if (v[l] > v[r])
-                                            c = l;              v[c = l] is the larger child
-                                          else
-                                            c = r;              v[c = r] is the larger child
-    if POT not satisfied                  if (v[c] > v[p])      parent/child in wrong order
-    swap                                    XC(v[c],v[p]);      exchange values between parent, child
-                                            p = c;              and reset parent
-      else                                 else
-    stop                                    finished = true;    POT PROPERTY is restored
-    Until POT                            } until finished;      nothing left to do
-
-[1], [2] are O(1)
-[3] is O(log size)
+[1] Take the last leaf out              t = v[n = size - 1];    v[0 .. n) is the heap left
+[2] Move the hole from the root to      h = 0; c = 2h + 2;      v[c] = right child of the hole
+    a leaf along the larger children    while (c < n) {
+    choose larger child (no branch)       c -= (v[c] < v[c-1]); right child on ties
+    move it up                            v[h] = v[c];
+                                          h = c; c = 2h + 2;
+                                        }
+    a last, lone left child             if (c == n) { v[h] = v[n-1]; h = n-1; }
+[3] Sift t up from the leaf             while (h > 0 && v[p = (h-1)/2] < t)
+                                          { v[h] = v[p]; h = p; }
+[4] Fill the hole, drop the last leaf   v[h] = t; v.pop_back();
+
+[2] is log size comparisons and assignments, no comparisons with t
+[3] is O(1) expected comparisons for random keys (O(log size) worst case)
    */
   {
-    g_pop_heap(c_.Begin(), c_.End(), p_);
+    size_t n = c_.Size() - 1;
+    if (n > 0)
+    {
+      T t = c_[n];
+      size_t h = 0;
+      size_t c = 2;
+      while (c < n)
+      {
+        c -= static_cast<size_t>(p_(c_[c], c_[c - 1]));
+        c_[h] = c_[c];
+        h = c;
+        c = 2 * h + 2;
+      }
+      if (c == n)
+      {
+        c_[h] = c_[n - 1];
+        h = n - 1;
+      }
+      while (h > 0)
+      {
+        size_t p = (h - 1) / 2;
+        if (!p_(c_[p], t))
+          break;
+        c_[h] = c_[p];
+        h = p;
+      }
+      c_[h] = t;
+    }
     c_.PopBack();
+    grow_.AfterPop(c_);
   }
 
   const T& Front () const
+  // O(1): the root of the heap is the largest element
   {
-    typedef typename ContainerType::ConstIterator IteratorType;
-    IteratorType i = fsu::g_max_element (c_.Begin(), c_.End(), p_);
-    return *i;
+    return c_.Front();
+  }
+
+  void Merge (PriorityQueue&& other)
+  // append the other vector; when it is large rebuild the heap bottom-up
+  // in O(n + m) (Floyd), otherwise push each new element up in turn,
+  // O(m log(n + m)); other is left empty
+  {
+    if (&other == this) return;
+    size_t n = c_.Size(), m = other.c_.Size();
+    this->Reserve(n + m);
+    for (size_t i = 0; i < m; ++i)
+      c_.PushBack(other.c_[i]);
+    other.c_.Clear();
+    size_t depth = 0;
+    for (size_t k = n + m; k > 1; k /= 2) ++depth;
+    if (m * depth > 2 * (n + m))
+      Heapify();
+    else
+      for (size_t k = n; k < n + m; ++k)
+        SiftUp(k);
   }
 
   void Clear ()
@@ -599,9 +1059,2689 @@ namespace pq6
     return p_;
   }
 
+  const C& GetContainer() const
+  // the container itself, to inspect (its backing, for a pqh::Vector)
+  {
+    return c_;
+  }
+
   void Dump (std::ostream& os, char ofc = '\0') const
   {
     c_.Display(os,ofc);
   }
  };
 } // namespace pq6
+
+
+namespace pq7
+{
+ template <typename T, class K, size_t N = 256>
+ class PriorityQueue
+ {
+  typedef typename fsu::Deque < T >              BucketType;
+  typedef T                                      ValueType;
+  typedef K                                      KeyType;
+  typedef unsigned long long                     WordType;
+
+  // store elements in one FIFO bucket per priority level
+  // level of t is k_(t), assumed to be an integer in [0,N)
+  // larger level = higher priority; ties are served first in, first out
+  // bits_ has bit l set exactly when bucket l is non-empty
+  // top_ is the highest non-empty level (meaningless when size_ == 0)
+  // Push(t): PushBack onto bucket k_(t), set its bit, raise top_
+  // Front(): front element of bucket top_
+  // Pop()  : PopFront from bucket top_; if that empties it, clear its bit
+  //          and find the next top_ with count-leading-zeros on bits_
+
+  static const size_t W = (N + 63) / 64;        // number of bitmap words
+
+  KeyType    k_;
+  BucketType b_[N];
+  WordType   bits_[W];
+  size_t     top_;
+  size_t     size_;
+
+  size_t Highest () const
+  // highest set bit of bits_, scanning down from the word holding top_
+  {
+    for (size_t w = top_ / 64 + 1; w > 0; --w)
+    {
+      if (bits_[w - 1] != 0)
+        return (w - 1) * 64 + 63 - __builtin_clzll(bits_[w - 1]);
+    }
+    return 0;
+  }
+
+ public:
+  PriorityQueue() : k_(), top_(0), size_(0)
+  {
+    for (size_t w = 0; w < W; ++w) bits_[w] = 0;
+  }
+
+  explicit PriorityQueue(K k) : k_(k), top_(0), size_(0)
+  {
+    for (size_t w = 0; w < W; ++w) bits_[w] = 0;
+  }
+
+  void Push (const T& t)
+  // O(1)
+  {
+    size_t l = static_cast<size_t>(k_(t));
+    b_[l].PushBack(t);
+    bits_[l / 64] |= WordType(1) << (l % 64);
+    if (size_ == 0 || l > top_) top_ = l;
+    ++size_;
+  }
+
+  void Pop ()
+  // O(1) (at most N/64 word tests when a level empties)
+  {
+    b_[top_].PopFront();
+    --size_;
+    if (b_[top_].Empty())
+    {
+      bits_[top_ / 64] &= ~(WordType(1) << (top_ % 64));
+      top_ = Highest();
+    }
+  }
+
+  const T& Front () const
+  // O(1)
+  {
+    return b_[top_].Front();
+  }
+
+  void Merge (PriorityQueue&& other)
+  // O(m + N/64): append each non-empty bucket of other to the same level
+  // here, FIFO order within a level as if other's elements were pushed
+  // later; other is left empty
+  {
+    if (&other == this) return;
+    for (size_t w = 0; w < W; ++w)
+    {
+      for (WordType m = other.bits_[w]; m != 0; m &= m - 1)
+      {
+        size_t l = w * 64 + __builtin_ctzll(m);
+        typedef typename BucketType::ConstIterator IteratorType;
+        for (IteratorType i = other.b_[l].Begin(); i != other.b_[l].End(); ++i)
+          b_[l].PushBack(*i);
+      }
+      bits_[w] |= other.bits_[w];
+    }
+    if (size_ == 0 || (other.size_ > 0 && other.top_ > top_))
+      top_ = other.top_;
+    size_ += other.size_;
+    other.Clear();
+  }
+
+  void Clear ()
+  {
+    for (size_t w = 0; w < W; ++w)
+    {
+      for (WordType m = bits_[w]; m != 0; m &= m - 1)
+        b_[w * 64 + __builtin_ctzll(m)].Clear();
+      bits_[w] = 0;
+    }
+    top_ = 0;
+    size_ = 0;
+  }
+
+  bool Empty () const
+  {
+    return size_ == 0;
+  }
+
+  size_t Size () const
+  {
+    return size_;
+  }
+
+  const K& GetKey() const
+  {
+    return k_;
+  }
+
+  void Dump (std::ostream& os, char ofc = '\0') const
+  // buckets in pop order: highest level first
+  {
+    for (size_t l = N; l > 0; --l)
+      b_[l - 1].Display(os,ofc);
+  }
+ };
+} // namespace pq7
+
+
+namespace pq8
+{
+ template <typename T, class K>
+ class PriorityQueue
+ {
+  typedef typename fsu::List < T >               BucketType;
+  typedef typename fsu::Vector < BucketType >    ContainerType;
+  typedef T                                      ValueType;
+  typedef K                                      KeyType;
+
+  // calendar queue (Brown, 1988)
+  // time is cut into "days" of length width_; day d = floor(time/width_) is
+  // kept in bucket d % nbuckets, so one sweep over the buckets is a "year"
+  // each bucket is a list sorted by time, FIFO among equal times
+  // cur_ is the day being served; no element is earlier than day cur_
+  // Push(t): sorted insert into the bucket of day(t); lower cur_ if needed
+  // Front(): sweep forward from cur_ to the first bucket whose first element
+  //          belongs to the current day; after a whole empty year, fall back
+  //          to a direct search for the earliest element
+  // Pop()  : Front(), then PopFront() that bucket
+  // The number of buckets doubles when size > 2*buckets and halves when
+  // size < buckets/2; on each resize width_ is recomputed from a sample of
+  // the earliest elements, about 3 times their average separation.
+
+  KeyType        k_;
+  ContainerType  c_;
+  size_t         mask_;       // c_.Size() - 1, c_.Size() a power of 2
+  double         width_;
+  size_t         size_;
+  mutable long long cur_;     // Front() moves the calendar forward
+
+  long long Day (const T& t) const
+  {
+    return static_cast<long long>(std::floor(k_(t) / width_));
+  }
+
+  void Insert (const T& t)
+  // sorted insert, scanning from the back so that equal times stay FIFO
+  {
+    BucketType& b = c_[static_cast<size_t>(Day(t)) & mask_];
+    typename BucketType::Iterator i = b.End();
+    while (i != b.Begin())
+    {
+      typename BucketType::Iterator j = i;
+      --j;
+      if (!(k_(t) < k_(*j))) break;
+      i = j;
+    }
+    b.Insert(i,t);
+  }
+
+  size_t Locate () const
+  // bucket holding the earliest element; size_ > 0
+  {
+    long long d = cur_;
+    for (size_t n = 0; n <= mask_; ++n, ++d)
+    {
+      const BucketType& b = c_[static_cast<size_t>(d) & mask_];
+      if (!b.Empty() && Day(b.Front()) <= d)
+      {
+        cur_ = d;
+        return static_cast<size_t>(d) & mask_;
+      }
+    }
+    // an empty year: direct search
+    size_t m = 0;
+    bool found = false;
+    for (size_t i = 0; i <= mask_; ++i)
+    {
+      if (!c_[i].Empty() && (!found || k_(c_[i].Front()) < k_(c_[m].Front())))
+      {
+        m = i;
+        found = true;
+      }
+    }
+    cur_ = Day(c_[m].Front());
+    return m;
+  }
+
+  void Resize (size_t buckets)
+  {
+    // sample the earliest elements to choose the new day width
+    size_t samples = (size_ <= 5) ? size_ : 5 + size_ / 10;
+    if (samples > 25) samples = 25;
+    fsu::Vector < T > sample;  // then every other element, for the new buckets
+    sample.SetCapacity(size_);
+    for (size_t n = 0; n < samples; ++n)
+    {
+      size_t i = Locate();
+      sample.PushBack(c_[i].Front());
+      c_[i].PopFront();
+    }
+    if (samples > 1)
+    {
+      double average = (k_(sample[samples - 1]) - k_(sample[0])) / (samples - 1);
+      double sum = 0;
+      size_t count = 0;
+      for (size_t n = 1; n < samples; ++n)
+      {
+        double gap = k_(sample[n]) - k_(sample[n - 1]);
+        if (gap <= 2 * average)
+        {
+          sum += gap;
+          ++count;
+        }
+      }
+      if (count > 0 && sum > 0)
+        width_ = 3 * sum / count;
+    }
+
+    // empty the buckets in place rather than copy them: the samples come
+    // first, as they precede any equal times left in the buckets
+    for (size_t i = 0; i < c_.Size(); ++i)
+      for (; !c_[i].Empty(); c_[i].PopFront())
+        sample.PushBack(c_[i].Front());
+    c_.Clear();
+    c_.SetSize(buckets);
+    mask_ = buckets - 1;
+    for (size_t n = 0; n < sample.Size(); ++n)
+      Insert(sample[n]);
+    if (samples > 0)
+      cur_ = Day(sample[0]);
+  }
+
+ public:
+  PriorityQueue() : k_(), c_(), mask_(1), width_(1.0), size_(0), cur_(0)
+  {
+    c_.SetSize(2);
+  }
+
+  explicit PriorityQueue(K k) : k_(k), c_(), mask_(1), width_(1.0), size_(0), cur_(0)
+  {
+    c_.SetSize(2);
+  }
+
+  void Push (const T& t)
+  // expected O(1)
+  {
+    Insert(t);
+    if (size_ == 0 || Day(t) < cur_)
+      cur_ = Day(t);
+    ++size_;
+    if (size_ > 2 * c_.Size())
+      Resize(2 * c_.Size());
+  }
+
+  void Pop ()
+  // expected O(1)
+  {
+    c_[Locate()].PopFront();
+    --size_;
+    if (c_.Size() > 2 && size_ < c_.Size() / 2)
+      Resize(c_.Size() / 2);
+  }
+
+  const T& Front () const
+  // expected O(1)
+  {
+    return c_[Locate()].Front();
+  }
+
+  void Merge (PriorityQueue&& other)
+  // expected O(m): push every element of other; other is left empty
+  {
+    if (&other == this) return;
+    for (size_t i = 0; i < other.c_.Size(); ++i)
+    {
+      for (typename BucketType::ConstIterator j = other.c_[i].Begin(); j != other.c_[i].End(); ++j)
+        Push(*j);
+    }
+    other.Clear();
+  }
+
+  void Clear ()
+  {
+    c_.Clear();
+    c_.SetSize(2);
+    mask_ = 1;
+    width_ = 1.0;
+    size_ = 0;
+    cur_ = 0;
+  }
+
+  bool Empty () const
+  {
+    return size_ == 0;
+  }
+
+  size_t Size () const
+  {
+    return size_;
+  }
+
+  const K& GetKey() const
+  {
+    return k_;
+  }
+
+  void Dump (std::ostream& os, char ofc = '\0') const
+  {
+    for (size_t i = 0; i < c_.Size(); ++i)
+      c_[i].Display(os,ofc);
+  }
+ };
+} // namespace pq8
+
+
+namespace pq9
+{
+ template <typename T, class P, size_t M = 256, size_t K = 64>
+ class PriorityQueue
+ {
+  typedef typename fsu::Vector < T >             RunType;
+  typedef T                                      ValueType;
+  typedef P                                      PredicateType;
+
+  // ins_   : binary heap of at most M recently pushed elements
+  // group g: up to K sorted runs (slots; an empty slot is free) plus a
+  //          buffer buf_ holding the largest elements of the group
+  // every run and buffer is in increasing order and is consumed from the
+  // back, so the largest remaining element of each is its Back()
+  // invariant: a group with any elements has a non-empty buffer, and
+  //            nothing in its runs is larger than anything in its buffer
+  // Push(t): if ins_ is full, sort it and merge it with buf_ of group 0
+  //          into a free run slot of group 0 (making room first), then
+  //          push t onto ins_
+  // Front(): largest of ins_[0] and the Back() of every group buffer
+  // Pop()  : remove that element; refill an emptied group buffer by
+  //          merging the M largest elements out of the group's runs
+  // Making room in a full group g merges all of its runs and buffer,
+  // together with the buffer of group g+1, into one run of group g+1.
+
+  struct Group
+  {
+    fsu::Vector < RunType > run_;    // K slots
+    RunType                 buf_;
+  };
+
+  class BackPredicate
+  // orders input indices by the Back() of the inputs
+  {
+  public:
+    BackPredicate(RunType** in, const P& p) : in_(in), p_(p) {}
+    bool operator () (size_t a, size_t b) const
+    {
+      return p_(in_[a]->Back(), in_[b]->Back());
+    }
+  private:
+    RunType** in_;
+    P         p_;
+  };
+
+  PredicateType            p_;
+  RunType                  ins_;
+  fsu::Vector < Group >    g_;
+  size_t                   size_;
+
+  void Merge (RunType** in, size_t n, RunType& out, size_t count)
+  // move the count largest elements of the n inputs into out, in order
+  // h is a heap of input indices keyed by their Back(); after each step
+  // the top is replaced (or dropped) and sifted down once
+  {
+    BackPredicate bp(in, p_);
+    size_t h[K + 2];
+    size_t m = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+      if (!in[i]->Empty())
+      {
+        h[m++] = i;
+        fsu::g_push_heap(h, h + m, bp);
+      }
+    }
+    out.SetSize(count);
+    for (size_t k = count; k > 0; --k)
+    {
+      size_t i = h[0];
+      out[k - 1] = in[i]->Back();
+      in[i]->PopBack();
+      if (in[i]->Empty())
+        i = h[--m];
+      size_t p = 0;
+      for (size_t c = 1; c < m; c = 2 * p + 1)
+      {
+        if (c + 1 < m && bp(h[c], h[c + 1])) ++c;
+        if (!bp(i, h[c])) break;
+        h[p] = h[c];
+        p = c;
+      }
+      h[p] = i;
+    }
+  }
+
+  void Refill (size_t g)
+  // buf_ of group g is empty: refill it from the runs
+  {
+    Group& G = g_[g];
+    RunType* in[K];
+    size_t n = 0, total = 0;
+    for (size_t r = 0; r < K; ++r)
+    {
+      if (!G.run_[r].Empty())
+      {
+        in[n++] = &G.run_[r];
+        total += G.run_[r].Size();
+      }
+    }
+    if (total > 0)
+      Merge(in, n, G.buf_, total < M ? total : M);
+  }
+
+  size_t FreeSlot (size_t g)
+  // a free run slot in group g, making room in the group if it is full
+  {
+    if (g_.Size() == g)
+    {
+      g_.SetSize(g + 1);
+      g_[g].run_.SetSize(K);
+    }
+    for (size_t r = 0; r < K; ++r)
+    {
+      if (g_[g].run_[r].Empty())
+        return r;
+    }
+    // full: merge everything in group g into one run of group g+1
+    size_t slot = FreeSlot(g + 1);
+    RunType* in[K + 2];
+    size_t total = 0;
+    for (size_t r = 0; r < K; ++r)
+    {
+      in[r] = &g_[g].run_[r];
+      total += in[r]->Size();
+    }
+    in[K] = &g_[g].buf_;
+    in[K + 1] = &g_[g + 1].buf_;
+    total += in[K]->Size() + in[K + 1]->Size();
+    Merge(in, K + 2, g_[g + 1].run_[slot], total);
+    Refill(g + 1);
+    return 0;
+  }
+
+  void Flush ()
+  // move the full insertion heap into group 0
+  {
+    size_t slot = FreeSlot(0);
+    fsu::g_heap_sort(ins_.Begin(), ins_.End(), p_);
+    RunType* in[2] = { &ins_, &g_[0].buf_ };
+    Merge(in, 2, g_[0].run_[slot], ins_.Size() + g_[0].buf_.Size());
+    Refill(0);
+  }
+
+  const T* Largest (size_t& where) const
+  // largest element; where = group index, or g_.Size() for ins_
+  {
+    const T* m = 0;
+    where = g_.Size();
+    if (!ins_.Empty())
+      m = &ins_[0];
+    for (size_t g = 0; g < g_.Size(); ++g)
+    {
+      if (!g_[g].buf_.Empty() && (m == 0 || p_(*m, g_[g].buf_.Back())))
+      {
+        m = &g_[g].buf_.Back();
+        where = g;
+      }
+    }
+    return m;
+  }
+
+ public:
+  PriorityQueue() : p_(), ins_(), g_(), size_(0)
+  {}
+
+  explicit PriorityQueue(P p) : p_(p), ins_(), g_(), size_(0)
+  {}
+
+  void Push (const T& t)
+  // amortized O(log n), mostly sequential merging
+  {
+    if (ins_.Size() == M)
+      Flush();
+    ins_.PushBack(t);
+    fsu::g_push_heap(ins_.Begin(), ins_.End(), p_);
+    ++size_;
+  }
+
+  void Pop ()
+  // amortized O(log n)
+  {
+    size_t where;
+    Largest(where);
+    if (where == g_.Size())
+    {
+      fsu::g_pop_heap(ins_.Begin(), ins_.End(), p_);
+      ins_.PopBack();
+    }
+    else
+    {
+      g_[where].buf_.PopBack();
+      if (g_[where].buf_.Empty())
+        Refill(where);
+    }
+    --size_;
+  }
+
+  const T& Front () const
+  // O(number of groups) = O(log_K (n/M))
+  {
+    size_t where;
+    return *Largest(where);
+  }
+
+  void Merge (PriorityQueue&& other)
+  // amortized O(m log(n + m)): push every element of other, run by run,
+  // so that flushes into group 0 stay sequential; other is left empty
+  {
+    if (&other == this) return;
+    for (size_t i = 0; i < other.ins_.Size(); ++i)
+      Push(other.ins_[i]);
+    for (size_t g = 0; g < other.g_.Size(); ++g)
+    {
+      const Group& G = other.g_[g];
+      for (size_t i = 0; i < G.buf_.Size(); ++i)
+        Push(G.buf_[i]);
+      for (size_t r = 0; r < K; ++r)
+        for (size_t i = 0; i < G.run_[r].Size(); ++i)
+          Push(G.run_[r][i]);
+    }
+    other.Clear();
+  }
+
+  void Clear ()
+  {
+    ins_.Clear();
+    g_.Clear();
+    size_ = 0;
+  }
+
+  bool Empty () const
+  {
+    return size_ == 0;
+  }
+
+  size_t Size () const
+  {
+    return size_;
+  }
+
+  const P& GetPredicate() const
+  {
+    return p_;
+  }
+
+  void Dump (std::ostream& os, char ofc = '\0') const
+  // insertion heap, then each group: buffer followed by its runs
+  {
+    ins_.Display(os,ofc);
+    for (size_t g = 0; g < g_.Size(); ++g)
+    {
+      g_[g].buf_.Display(os,ofc);
+      for (size_t r = 0; r < K; ++r)
+        g_[g].run_[r].Display(os,ofc);
+    }
+  }
+ };
+} // namespace pq9
+
+namespace pq10
+{
+ template <typename T, class P, size_t D = 4>
+ class PriorityQueue
+ {
+  typedef typename fsu::Vector < T >             ContainerType;
+  typedef T                                      ValueType;
+  typedef P                                      PredicateType;
+
+  // store elements in a D-ary heap: the children of c_[i] are
+  // c_[D*i + 1] .. c_[D*i + D], the parent of c_[i] is c_[(i - 1)/D]
+  // first element(root) is largest
+  // Push(t): PushBack(t), then move the "hole" up: parents smaller than t
+  //          move down one level, t is written once where it fits
+  // Pop()  : take the last leaf out, move the hole down from the root
+  //          along the largest child, write the leaf once where it fits
+  // A shallower tree (log_D n levels) and children sharing a cache line
+  // trade a few more comparisons per level for fewer cache misses.
+
+  PredicateType  p_;
+  ContainerType  c_;
+
+  static size_t Depth (size_t n)
+  // levels below the root in a D-ary heap of n elements
+  {
+    size_t d = 0;
+    for (size_t k = n; k > 1; k /= D) ++d;
+    return d;
+  }
+
+  void Heapify ()
+  // Floyd: sift every parent down, last parent first; O(size)
+  {
+    size_t n = c_.Size();
+    for (size_t i = (n + D - 2) / D; i > 0; --i)
+    {
+      T t = c_[i - 1];
+      size_t p = i - 1;
+      for (size_t l = D * p + 1; l < n; l = D * p + 1)
+      {
+        size_t e = (l + D < n) ? l + D : n;
+        size_t c = l;
+        for (size_t j = l + 1; j < e; ++j)
+          if (p_(c_[c], c_[j])) c = j;
+        if (!p_(t, c_[c]))
+          break;
+        c_[p] = c_[c];
+        p = c;
+      }
+      c_[p] = t;
+    }
+  }
+
+ public:
+  PriorityQueue() : p_(), c_()
+  {}
+
+  explicit PriorityQueue(P p) : p_(p), c_()
+  {}
+
+  void Push (const T& t)
+  // O(log_D n)
+  {
+    c_.PushBack(t);
+    size_t c = c_.Size() - 1;
+    while (c > 0)
+    {
+      size_t p = (c - 1) / D;
+      if (!p_(c_[p], t))
+        break;
+      c_[c] = c_[p];
+      c = p;
+    }
+    c_[c] = t;
+  }
+
+  void Pop ()
+  // O(D log_D n)
+  {
+    size_t n = c_.Size() - 1;
+    if (n > 0)
+    {
+      T t = c_[n];
+      size_t p = 0;
+      for (size_t l = 1; l < n; l = D * p + 1)
+      {
+        size_t e = (l + D < n) ? l + D : n;
+        size_t c = l;
+        for (size_t i = l + 1; i < e; ++i)
+          if (p_(c_[c], c_[i])) c = i;
+        if (!p_(t, c_[c]))
+          break;
+        c_[p] = c_[c];
+        p = c;
+      }
+      c_[p] = t;
+    }
+    c_.PopBack();
+  }
+
+  const T& Front () const
+  // O(1)
+  {
+    return c_.Front();
+  }
+
+  void Merge (PriorityQueue&& other)
+  // append the other vector; when it is large rebuild the heap bottom-up
+  // in O(n + m), otherwise push each new element up; other is left empty
+  {
+    if (&other == this) return;
+    size_t n = c_.Size(), m = other.c_.Size();
+    if (m * Depth(n + m) > 2 * (n + m))
+    {
+      for (size_t i = 0; i < m; ++i)
+        c_.PushBack(other.c_[i]);
+      Heapify();
+    }
+    else
+      for (size_t i = 0; i < m; ++i)
+        Push(other.c_[i]);
+    other.c_.Clear();
+  }
+
+  void Clear ()
+  {
+    c_.Clear();
+  }
+
+  bool Empty () const
+  {
+    return c_.Empty();
+  }
+
+  size_t Size () const
+  {
+    return c_.Size();
+  }
+
+  const P& GetPredicate() const
+  {
+    return p_;
+  }
+
+  void Dump (std::ostream& os, char ofc = '\0') const
+  {
+    c_.Display(os,ofc);
+  }
+ };
+} // namespace pq10
+
+
+namespace pq11
+{
+ template <typename T, class K, class P>
+ class PriorityQueue
+ {
+ public:
+  typedef typename std::decay < decltype(std::declval<const K&>()(std::declval<const T&>())) > ::type KeyType;
+
+ private:
+  struct Entry
+  {
+    KeyType key_;
+    size_t  slot_;
+  };
+
+  typedef typename fsu::Vector < Entry >         HeapType;
+  typedef typename fsu::Vector < T >             SlotType;
+  typedef T                                      ValueType;
+  typedef P                                      PredicateType;
+
+  // h_ is a heap of (key, slot) entries ordered by p_ on the keys
+  // s_[slot] holds the element; free_ lists the slots of popped elements
+  // first entry(root) has the largest key
+  // Push(t): store t in a free slot, then move a hole up h_ for (k_(t), slot)
+  // Front(): s_[h_[0].slot_]
+  // Pop()  : free the root's slot, move the last entry down from the root
+  //          (hole-based, one entry copy per level)
+
+  K              k_;
+  PredicateType  p_;
+  HeapType       h_;
+  SlotType       s_;
+  fsu::Vector < size_t > free_;
+
+  void Insert (const KeyType& key, const T& t)
+  // store t in a free slot, then move a hole up h_ for (key, slot)
+  {
+    Entry e;
+    e.key_ = key;
+    if (free_.Empty())
+    {
+      e.slot_ = s_.Size();
+      s_.PushBack(t);
+    }
+    else
+    {
+      e.slot_ = free_.Back();
+      free_.PopBack();
+      s_[e.slot_] = t;
+    }
+    h_.PushBack(e);
+    size_t c = h_.Size() - 1;
+    while (c > 0)
+    {
+      size_t p = (c - 1) / 2;
+      if (!p_(h_[p].key_, e.key_))
+        break;
+      h_[c] = h_[p];
+      c = p;
+    }
+    h_[c] = e;
+  }
+
+ public:
+  PriorityQueue() : k_(), p_(), h_(), s_(), free_()
+  {}
+
+  explicit PriorityQueue(K k, P p = P()) : k_(k), p_(p), h_(), s_(), free_()
+  {}
+
+  void Push (const T& t)
+  // O(log n) entry moves, one element copy
+  {
+    Insert(k_(t), t);
+  }
+
+  void Pop ()
+  // O(log n) entry moves, no element copies
+  {
+    free_.PushBack(h_[0].slot_);
+    size_t n = h_.Size() - 1;
+    if (n > 0)
+    {
+      Entry e = h_[n];
+      size_t p = 0;
+      for (size_t c = 1; c < n; c = 2 * p + 1)
+      {
+        if (c + 1 < n && p_(h_[c].key_, h_[c + 1].key_)) ++c;
+        if (!p_(e.key_, h_[c].key_))
+          break;
+        h_[p] = h_[c];
+        p = c;
+      }
+      h_[p] = e;
+    }
+    h_.PopBack();
+  }
+
+  const T& Front () const
+  // O(1)
+  {
+    return s_[h_[0].slot_];
+  }
+
+  void Merge (PriorityQueue&& other)
+  // O(m log(n + m)): push every element of other, reusing its keys;
+  // other is left empty
+  {
+    if (&other == this) return;
+    for (size_t i = 0; i < other.h_.Size(); ++i)
+      Insert(other.h_[i].key_, other.s_[other.h_[i].slot_]);
+    other.Clear();
+  }
+
+  void Clear ()
+  {
+    h_.Clear();
+    s_.Clear();
+    free_.Clear();
+  }
+
+  bool Empty () const
+  {
+    return h_.Empty();
+  }
+
+  size_t Size () const
+  {
+    return h_.Size();
+  }
+
+  const P& GetPredicate() const
+  {
+    return p_;
+  }
+
+  const K& GetKey() const
+  {
+    return k_;
+  }
+
+  void Dump (std::ostream& os, char ofc = '\0') const
+  // elements in heap order
+  {
+    for (size_t i = 0; i < h_.Size(); ++i)
+    {
+      os << s_[h_[i].slot_];
+      if (ofc != '\0') os << ofc;
+    }
+  }
+ };
+} // namespace pq11
+
+
+namespace pq12
+{
+ template <typename T, class P, size_t N>
+ class StaticPriorityQueue
+ {
+  typedef T                                      ValueType;
+  typedef P                                      PredicateType;
+
+  // store up to N elements as a heap in the inline array a_[0 .. size_)
+  // first element(root) is largest
+  // TryPush(t): false if full, else move a hole up from a_[size_] for t
+  // Front()   : a_[0]
+  // Pop()     : move the hole down from the root for the last element
+
+  PredicateType  p_;
+  T              a_[N];
+  size_t         size_;
+
+ public:
+  constexpr StaticPriorityQueue() : p_(), a_(), size_(0)
+  {}
+
+  constexpr explicit StaticPriorityQueue(P p) : p_(p), a_(), size_(0)
+  {}
+
+  constexpr bool TryPush (const T& t)
+  // O(log n)
+  {
+    if (size_ == N)
+      return false;
+    size_t c = size_++;
+    while (c > 0)
+    {
+      size_t p = (c - 1) / 2;
+      if (!p_(a_[p], t))
+        break;
+      a_[c] = a_[p];
+      c = p;
+    }
+    a_[c] = t;
+    return true;
+  }
+
+  constexpr void Push (const T& t)
+  // O(log n); the queue must not be Full(): use TryPush when it may be
+  {
+    assert(size_ < N);
+    TryPush(t);
+  }
+
+  constexpr void Pop ()
+  // O(log n)
+  {
+    size_t n = --size_;
+    if (n > 0)
+    {
+      T t = a_[n];
+      size_t p = 0;
+      for (size_t c = 1; c < n; c = 2 * p + 1)
+      {
+        if (c + 1 < n && p_(a_[c], a_[c + 1])) ++c;
+        if (!p_(t, a_[c]))
+          break;
+        a_[p] = a_[c];
+        p = c;
+      }
+      a_[p] = t;
+    }
+  }
+
+  constexpr const T& Front () const
+  // O(1)
+  {
+    return a_[0];
+  }
+
+  constexpr bool Merge (StaticPriorityQueue&& other)
+  // O(m log(n + m)): move the largest elements of other over while there
+  // is room; false if some did not fit, and those (the smallest) stay
+  // in other
+  {
+    if (&other == this) return true;
+    while (!other.Empty() && TryPush(other.Front()))
+      other.Pop();
+    return other.Empty();
+  }
+
+  constexpr void Clear ()
+  {
+    size_ = 0;
+  }
+
+  constexpr bool Empty () const
+  {
+    return size_ == 0;
+  }
+
+  constexpr bool Full () const
+  {
+    return size_ == N;
+  }
+
+  constexpr size_t Size () const
+  {
+    return size_;
+  }
+
+  static constexpr size_t Capacity ()
+  {
+    return N;
+  }
+
+  constexpr const P& GetPredicate() const
+  {
+    return p_;
+  }
+
+  void Dump (std::ostream& os, char ofc = '\0') const
+  {
+    for (size_t i = 0; i < size_; ++i)
+    {
+      os << a_[i];
+      if (ofc != '\0') os << ofc;
+    }
+  }
+ };
+} // namespace pq12
+
+
+namespace pq13
+{
+ struct Statistics
+ {
+  size_t pushes_;     // total Push calls
+  size_t pops_;       // total Pop calls
+  size_t toHeap_;     // migrations sorted -> heap
+  size_t toSorted_;   // migrations heap -> sorted
+  size_t peak_;       // largest size seen
+  bool   heap_;       // current representation is the heap
+
+  Statistics() : pushes_(0), pops_(0), toHeap_(0), toSorted_(0), peak_(0), heap_(false)
+  {}
+
+  void Display (std::ostream& os) const
+  {
+    os << "pushes " << pushes_ << ", pops " << pops_
+       << ", sorted->heap " << toHeap_ << ", heap->sorted " << toSorted_
+       << ", peak size " << peak_
+       << ", now " << (heap_ ? "heap" : "sorted") << '\n';
+  }
+ };
+
+ template <typename T, class P >
+ class PriorityQueue
+ {
+  typedef typename fsu::Vector < T >             ContainerType;
+  typedef T                                      ValueType;
+  typedef P                                      PredicateType;
+
+  // sorted: c_ in increasing order, last element is largest
+  //   Push(t): binary search for the upper bound, shift the tail up one
+  //   Front(): c_.Back()
+  //   Pop()  : c_.PopBack()
+  // heap: c_ is a heap, first element(root) is largest
+  //   Push(t): PushBack(t), then g_push_heap()
+  //   Front(): c_.Front()
+  //   Pop()  : g_pop_heap(), then PopBack()
+  // sorted -> heap : reverse c_ (a decreasing array is a heap), O(n)
+  // heap -> sorted : g_heap_sort(), O(n log n) on a small queue
+
+  PredicateType  p_;
+  ContainerType  c_;
+  Statistics     s_;
+  size_t         heapMin_, sortedMax_, window_;
+  double         popHeavy_;
+  size_t         ops_, windowPops_;      // current window
+
+  void ToHeap ()
+  {
+    for (size_t i = 0, j = c_.Size(); i + 1 < j; ++i, --j)
+      fsu::Swap(c_[i], c_[j - 1]);
+    s_.heap_ = true;
+    ++s_.toHeap_;
+  }
+
+  void ToSorted ()
+  {
+    fsu::g_heap_sort(c_.Begin(), c_.End(), p_);
+    s_.heap_ = false;
+    ++s_.toSorted_;
+  }
+
+  void Adapt ()
+  // end of a window: choose the representation for the next one
+  {
+    bool popHeavy = windowPops_ >= popHeavy_ * ops_;
+    if (!s_.heap_ && c_.Size() > sortedMax_)
+      ToHeap();
+    else if (s_.heap_ && (c_.Size() < heapMin_ || (popHeavy && c_.Size() <= sortedMax_)))
+      ToSorted();
+    ops_ = 0;
+    windowPops_ = 0;
+  }
+
+ public:
+  PriorityQueue() : p_(), c_(), s_(), heapMin_(16), sortedMax_(64), window_(256),
+                    popHeavy_(0.9), ops_(0), windowPops_(0)
+  {}
+
+  explicit PriorityQueue(P p) : p_(p), c_(), s_(), heapMin_(16), sortedMax_(64), window_(256),
+                                popHeavy_(0.9), ops_(0), windowPops_(0)
+  {}
+
+  void Push (const T& t)
+  // sorted: O(n); heap: O(log n)
+  {
+    if (s_.heap_)
+    {
+      c_.PushBack(t);
+      fsu::g_push_heap(c_.Begin(), c_.End(), p_);
+    }
+    else
+    {
+      size_t lo = 0, hi = c_.Size();
+      while (lo < hi)
+      {
+        size_t mid = (lo + hi) / 2;
+        if (p_(t, c_[mid])) hi = mid;
+        else                lo = mid + 1;
+      }
+      c_.PushBack(t);
+      for (size_t i = c_.Size() - 1; i > lo; --i)
+        c_[i] = c_[i - 1];
+      c_[lo] = t;
+    }
+    ++s_.pushes_;
+    if (c_.Size() > s_.peak_) s_.peak_ = c_.Size();
+    if (++ops_ >= window_ || (!s_.heap_ && c_.Size() > 2 * sortedMax_)) Adapt();
+  }
+
+  void Pop ()
+  // sorted: O(1); heap: O(log n)
+  {
+    if (s_.heap_)
+      fsu::g_pop_heap(c_.Begin(), c_.End(), p_);
+    c_.PopBack();
+    ++s_.pops_;
+    ++windowPops_;
+    if (++ops_ >= window_) Adapt();
+  }
+
+  const T& Front () const
+  // O(1)
+  {
+    return s_.heap_ ? c_.Front() : c_.Back();
+  }
+
+  void Merge (PriorityQueue&& other)
+  // two sorted queues whose union fits SortedMax: sorted merge, O(n + m);
+  // otherwise migrate *this to the heap and push other's elements in;
+  // other is left empty
+  {
+    if (&other == this) return;
+    size_t n = c_.Size(), m = other.c_.Size();
+    if (!s_.heap_ && !other.s_.heap_ && n + m <= sortedMax_)
+    {
+      ContainerType c;
+      c.SetSize(n + m);
+      size_t i = 0, j = 0, k = 0;
+      while (i < n && j < m)
+        c[k++] = p_(other.c_[j], c_[i]) ? other.c_[j++] : c_[i++];
+      while (i < n) c[k++] = c_[i++];
+      while (j < m) c[k++] = other.c_[j++];
+      c_ = c;
+    }
+    else
+    {
+      if (!s_.heap_) ToHeap();
+      for (size_t j = 0; j < m; ++j)
+      {
+        c_.PushBack(other.c_[j]);
+        fsu::g_push_heap(c_.Begin(), c_.End(), p_);
+      }
+    }
+    if (c_.Size() > s_.peak_) s_.peak_ = c_.Size();
+    other.Clear();
+  }
+
+  void Clear ()
+  {
+    c_.Clear();
+    s_.heap_ = false;
+    ops_ = 0;
+    windowPops_ = 0;
+  }
+
+  bool Empty () const
+  {
+    return c_.Empty();
+  }
+
+  size_t Size () const
+  {
+    return c_.Size();
+  }
+
+  const P& GetPredicate() const
+  {
+    return p_;
+  }
+
+  void SetThresholds (size_t heapMin, size_t sortedMax, size_t window = 256, double popHeavy = 0.9)
+  // heapMin <= sortedMax; window >= 1; popHeavy in (0,1]
+  {
+    heapMin_ = heapMin;
+    sortedMax_ = sortedMax;
+    window_ = window;
+    popHeavy_ = popHeavy;
+  }
+
+  size_t HeapMin   () const { return heapMin_; }
+  size_t SortedMax () const { return sortedMax_; }
+  size_t Window    () const { return window_; }
+  double PopHeavy  () const { return popHeavy_; }
+
+  const Statistics& GetStatistics () const
+  {
+    return s_;
+  }
+
+  void Dump (std::ostream& os, char ofc = '\0') const
+  {
+    c_.Display(os,ofc);
+  }
+ };
+} // namespace pq13
+
+
+namespace pq14
+{
+ template <typename T, class P >
+ class PriorityQueue
+ {
+  typedef typename fsu::Vector < T >             ContainerType;
+  typedef fsu::Vector < unsigned char >          BitsType;
+  typedef T                                      ValueType;
+  typedef P                                      PredicateType;
+
+  // weak heap (Dutton 1993): c_[0] is largest and has only a right
+  // subtree, rooted at c_[1]; the children of c_[i] are c_[2i + r_[i]]
+  // (left) and c_[2i + 1 - r_[i]] (right), so flipping the reverse bit
+  // r_[i] swaps the two subtrees of i without moving anything
+  // weak heap order: no element is smaller than anything in its right
+  // subtree; the left subtree is unordered with respect to it
+  // the distinguished ancestor of j is the parent of the first node on
+  // the path from j up that is a right child: the one node c_[j] must
+  // not exceed
+  // Join(i,j): i the distinguished ancestor of j; if c_[i] < c_[j] swap
+  //            them and flip r_[j]; exactly one comparison
+  // Push(t): append t, join upward until a join does not swap; O(1)
+  //          comparisons on average
+  // Front(): c_[0]
+  // Pop()  : move the last element to the root, then join the root with
+  //          every node on the path of left children below c_[1], bottom
+  //          up; at most ceil(log2 n) comparisons, about n log n - n
+  //          for n pops
+
+  PredicateType  p_;
+  ContainerType  c_;
+  BitsType       r_;
+
+  size_t DAncestor (size_t j) const
+  {
+    while ((j & 1) == r_[j >> 1])
+      j >>= 1;
+    return j >> 1;
+  }
+
+  bool Join (size_t i, size_t j)
+  // true if c_[i] already is not smaller than c_[j]
+  {
+    if (!p_(c_[i], c_[j]))
+      return true;
+    fsu::Swap(c_[i], c_[j]);
+    r_[j] = !r_[j];
+    return false;
+  }
+
+  void SiftUp (size_t j)
+  {
+    while (j != 0)
+    {
+      size_t i = DAncestor(j);
+      if (Join(i, j))
+        break;
+      j = i;
+    }
+  }
+
+  void Rebuild ()
+  // weak-heapify all of c_: n - 1 comparisons
+  {
+    for (size_t j = 0; j < r_.Size(); ++j)
+      r_[j] = 0;
+    for (size_t j = c_.Size(); j > 1; --j)
+      Join(DAncestor(j - 1), j - 1);
+  }
+
+ public:
+  PriorityQueue() : p_(), c_(), r_()
+  {}
+
+  explicit PriorityQueue(P p) : p_(p), c_(), r_()
+  {}
+
+  void Push (const T& t)
+  // O(log n), O(1) comparisons on average
+  {
+    size_t n = c_.Size();
+    c_.PushBack(t);
+    r_.PushBack(0);
+    if ((n & 1) == 0 && n > 0)
+      r_[n >> 1] = 0;      // n is the only child of n/2: make it the left one
+    SiftUp(n);
+  }
+
+  void Pop ()
+  // at most ceil(log2 n) comparisons
+  {
+    size_t n = c_.Size() - 1;
+    c_[0] = c_[n];
+    c_.PopBack();
+    r_.PopBack();
+    if (n > 1)
+    {
+      size_t j = 1;
+      for (size_t k = 2 + r_[1]; k < n; k = 2 * j + r_[j])
+        j = k;
+      for (; j != 0; j >>= 1)
+        Join(0, j);
+    }
+  }
+
+  const T& Front () const
+  // O(1)
+  {
+    return c_.Front();
+  }
+
+  void Merge (PriorityQueue&& other)
+  // append the other vector; rebuild with n + m - 1 comparisons when it
+  // is large, otherwise sift each new element up; other is left empty
+  {
+    if (&other == this) return;
+    size_t n = c_.Size(), m = other.c_.Size();
+    for (size_t i = 0; i < m; ++i)
+    {
+      c_.PushBack(other.c_[i]);
+      r_.PushBack(0);
+    }
+    other.Clear();
+    if (m > n / 4)
+      Rebuild();
+    else
+      for (size_t j = n; j < n + m; ++j)
+      {
+        if ((j & 1) == 0 && j > 0) r_[j >> 1] = 0;
+        SiftUp(j);
+      }
+  }
+
+  void Clear ()
+  {
+    c_.Clear();
+    r_.Clear();
+  }
+
+  bool Empty () const
+  {
+    return c_.Empty();
+  }
+
+  size_t Size () const
+  {
+    return c_.Size();
+  }
+
+  const P& GetPredicate() const
+  {
+    return p_;
+  }
+
+  void Dump (std::ostream& os, char ofc = '\0') const
+  {
+    c_.Display(os,ofc);
+  }
+ };
+} // namespace pq14
+
+
+namespace pq15
+{
+ template <typename T, class P >
+ class PriorityQueue
+ {
+  typedef T                                      ValueType;
+  typedef P                                      PredicateType;
+
+  // persistent leftist heap: the nodes are shared between every queue
+  // copied from the same one, and a shared node is never changed
+  // rank(x) = length of the right spine of x; leftist: rank(left) >= rank(right)
+  // so the right spine has at most log2(n + 1) nodes
+  // Meld(a,b): the larger root, its left subtree kept, its right subtree
+  //            Meld(right, other); swap children to keep leftist; only
+  //            the nodes on the two right spines are visited: O(log n)
+  //            a visited node is changed in place when this queue holds
+  //            the only reference to it, and copied otherwise
+  // Push(t): Meld(root, node(t))
+  // Front(): root
+  // Pop()  : Meld(left, right)
+  // copy   : O(1), one more reference to the root
+  // so an unshared queue allocates only on Push, and a queue sharing
+  // with a snapshot copies O(log n) nodes per operation until the two
+  // have parted
+  // a node is freed when the last queue holding it lets go; reference
+  // counts are plain integers: share a queue between threads only with
+  // a lock
+
+  struct Node
+  {
+    T       value_;
+    size_t  rank_;
+    size_t  refs_;
+    Node*   left_;
+    Node*   right_;
+
+    Node (const T& t, Node* l, Node* r) : value_(t), rank_(1), refs_(1), left_(l), right_(r)
+    {
+      Fix();
+    }
+
+    void Fix ()
+    // restore leftist and rank after right_ has changed
+    {
+      size_t lr = left_ ? left_->rank_ : 0, rr = right_ ? right_->rank_ : 0;
+      if (lr < rr)
+      {
+        Node* t = left_; left_ = right_; right_ = t;
+        rr = lr;
+      }
+      rank_ = rr + 1;
+    }
+  };
+
+  PredicateType  p_;
+  Node*          root_;
+  size_t         size_;
+
+  static Node* Retain (Node* n)
+  {
+    if (n) ++n->refs_;
+    return n;
+  }
+
+  static void Release (Node* n)
+  // iterative: a left spine can be as long as the queue; the stack is
+  // needed only where both children of a freed node are freed too
+  {
+    if (n == 0 || --n->refs_ > 0) return;
+    fsu::Vector < Node* > s;
+    while (n != 0)
+    {
+      Node* l = n->left_;
+      Node* r = n->right_;
+      delete n;
+      if (l && --l->refs_ > 0) l = 0;
+      if (r && --r->refs_ > 0) r = 0;
+      if (l && r) s.PushBack(r);
+      n = l ? l : r;
+      if (n == 0 && !s.Empty())
+      {
+        n = s.Back();
+        s.PopBack();
+      }
+    }
+  }
+
+  Node* Meld (Node* a, Node* b) const
+  // the union of a and b; takes over one reference to each
+  {
+    if (a == 0) return b;
+    if (b == 0) return a;
+    if (p_(a->value_, b->value_))
+    {
+      Node* t = a; a = b; b = t;
+    }
+    if (a->refs_ == 1)
+    {
+      a->right_ = Meld(a->right_, b);
+      a->Fix();
+      return a;
+    }
+    --a->refs_;                                // still held by another queue
+    return new Node(a->value_, Retain(a->left_), Meld(Retain(a->right_), b));
+  }
+
+ public:
+  PriorityQueue() : p_(), root_(0), size_(0)
+  {}
+
+  explicit PriorityQueue(P p) : p_(p), root_(0), size_(0)
+  {}
+
+  PriorityQueue(const PriorityQueue& q) : p_(q.p_), root_(Retain(q.root_)), size_(q.size_)
+  // O(1) snapshot
+  {}
+
+  PriorityQueue(PriorityQueue&& q) : p_(q.p_), root_(q.root_), size_(q.size_)
+  {
+    q.root_ = 0;
+    q.size_ = 0;
+  }
+
+  PriorityQueue& operator = (const PriorityQueue& q)
+  // O(1) snapshot, plus freeing what only *this held
+  {
+    Node* n = Retain(q.root_);
+    Release(root_);
+    root_ = n;
+    p_ = q.p_;
+    size_ = q.size_;
+    return *this;
+  }
+
+  PriorityQueue& operator = (PriorityQueue&& q)
+  {
+    if (this != &q)
+    {
+      Release(root_);
+      root_ = q.root_;
+      p_ = q.p_;
+      size_ = q.size_;
+      q.root_ = 0;
+      q.size_ = 0;
+    }
+    return *this;
+  }
+
+  ~PriorityQueue()
+  {
+    Release(root_);
+  }
+
+  void Push (const T& t)
+  // O(log n); copies never see the new element
+  {
+    root_ = Meld(root_, new Node(t, 0, 0));
+    ++size_;
+  }
+
+  void Pop ()
+  // O(log n); copies keep the old front
+  {
+    Node* r = root_;
+    if (r->refs_ == 1)
+    {
+      root_ = Meld(r->left_, r->right_);
+      delete r;
+    }
+    else
+    {
+      --r->refs_;
+      root_ = Meld(Retain(r->left_), Retain(r->right_));
+    }
+    --size_;
+  }
+
+  const T& Front () const
+  // O(1)
+  {
+    return root_->value_;
+  }
+
+  void Merge (PriorityQueue&& other)
+  // O(log n + log m); other is left empty
+  {
+    if (&other == this) return;
+    root_ = Meld(root_, other.root_);
+    size_ += other.size_;
+    other.root_ = 0;
+    other.size_ = 0;
+  }
+
+  void Clear ()
+  {
+    Release(root_);
+    root_ = 0;
+    size_ = 0;
+  }
+
+  bool Empty () const
+  {
+    return root_ == 0;
+  }
+
+  size_t Size () const
+  {
+    return size_;
+  }
+
+  const P& GetPredicate() const
+  {
+    return p_;
+  }
+
+  void Dump (std::ostream& os, char ofc = '\0') const
+  // elements in preorder
+  {
+    if (root_ == 0) return;
+    fsu::Vector < const Node* > s;
+    s.PushBack(root_);
+    while (!s.Empty())
+    {
+      const Node* n = s.Back();
+      s.PopBack();
+      os << n->value_;
+      if (ofc != '\0') os << ofc;
+      if (n->right_) s.PushBack(n->right_);
+      if (n->left_)  s.PushBack(n->left_);
+    }
+  }
+ };
+} // namespace pq15
+
+
+namespace pq16
+{
+ template <typename T, class P >
+ class PriorityQueue
+ {
+  typedef typename fsu::Vector < T >             ContainerType;
+  typedef T                                      ValueType;
+  typedef P                                      PredicateType;
+
+  // interval heap: node k holds the interval [c_[2k], c_[2k+1]], the
+  // last node possibly just c_[2k]; parent of node k is (k-1)/2, and
+  // every interval lies inside its parent's
+  // so the left ends form a min heap and the right ends a max heap
+  // Push(t): append; order the last node; then sift t up the min heap if
+  //          it is below the parent's left end, or up the max heap if it
+  //          is above the parent's right end
+  // Front() : c_[1] (c_[0] when alone)     FrontMin(): c_[0]
+  // Pop()   : the last element x fills the hole at c_[1]; sift it down
+  //           the max heap, and at each node swap x with the left end if
+  //           it is smaller
+  // PopMin(): the same at c_[0] down the min heap
+  // both ends O(log n), half the height of a binary heap
+
+  PredicateType  p_;
+  ContainerType  c_;
+
+  size_t High (size_t k, size_t n) const
+  // index of the right end of node k of a heap of n elements
+  {
+    return 2 * k + 1 < n ? 2 * k + 1 : 2 * k;
+  }
+
+  void SiftUpMin (size_t k, T t)
+  // t goes to the left end of node k or above
+  {
+    while (k > 0)
+    {
+      size_t q = (k - 1) / 2;
+      if (!p_(t, c_[2 * q])) break;
+      c_[2 * k] = c_[2 * q];
+      k = q;
+    }
+    c_[2 * k] = t;
+  }
+
+  void SiftUpMax (size_t i, T t)
+  // t goes to c_[i], the right end of its node, or above
+  {
+    size_t k = i / 2;
+    while (k > 0)
+    {
+      size_t q = (k - 1) / 2;
+      if (!p_(c_[2 * q + 1], t)) break;
+      c_[i] = c_[2 * q + 1];
+      k = q;
+      i = 2 * q + 1;
+    }
+    c_[i] = t;
+  }
+
+ public:
+  PriorityQueue() : p_(), c_()
+  {}
+
+  explicit PriorityQueue(P p) : p_(p), c_()
+  {}
+
+  void Push (const T& t)
+  // O(log n)
+  {
+    size_t n = c_.Size();
+    c_.PushBack(t);
+    size_t k = n / 2;
+    if (n & 1)                                  // t completes node k
+    {
+      if (p_(t, c_[n - 1]))
+      {
+        c_[n] = c_[n - 1];
+        SiftUpMin(k, t);
+      }
+      else
+        SiftUpMax(n, t);
+    }
+    else if (k > 0)                             // t alone in node k
+    {
+      size_t q = (k - 1) / 2;
+      if (p_(t, c_[2 * q]))
+        SiftUpMin(k, t);
+      else if (p_(c_[2 * q + 1], t))
+        SiftUpMax(n, t);
+    }
+  }
+
+  void Pop ()
+  // O(log n): the largest
+  {
+    size_t n = c_.Size() - 1;
+    if (n < 2)
+    {
+      c_.PopBack();
+      return;
+    }
+    T x = c_[n];
+    c_.PopBack();
+    size_t k = 0, i = 1;                        // the hole
+    for (size_t c = 1; 2 * c < n; c = 2 * k + 1)
+    {
+      size_t j = High(c, n);
+      if (2 * c + 2 < n && p_(c_[j], c_[High(c + 1, n)]))
+      {
+        ++c;
+        j = High(c, n);
+      }
+      if (!p_(x, c_[j])) break;
+      c_[i] = c_[j];
+      k = c;
+      i = j;
+      if (i != 2 * k && p_(x, c_[2 * k]))
+      {
+        T y = c_[2 * k]; c_[2 * k] = x; x = y;
+      }
+    }
+    c_[i] = x;
+  }
+
+  void PopMin ()
+  // O(log n): the smallest
+  {
+    size_t n = c_.Size() - 1;
+    if (n < 2)
+    {
+      if (n == 1) c_[0] = c_[1];
+      c_.PopBack();
+      return;
+    }
+    T x = c_[n];
+    c_.PopBack();
+    size_t k = 0;                               // the hole is c_[2k]
+    for (size_t c = 1; 2 * c < n; c = 2 * k + 1)
+    {
+      if (2 * c + 2 < n && p_(c_[2 * c + 2], c_[2 * c]))
+        ++c;
+      if (!p_(c_[2 * c], x)) break;
+      c_[2 * k] = c_[2 * c];
+      k = c;
+      if (2 * k + 1 < n && p_(c_[2 * k + 1], x))
+      {
+        T y = c_[2 * k + 1]; c_[2 * k + 1] = x; x = y;
+      }
+    }
+    c_[2 * k] = x;
+  }
+
+  const T& Front () const
+  // O(1): the largest
+  {
+    return c_.Size() > 1 ? c_[1] : c_[0];
+  }
+
+  const T& FrontMin () const
+  // O(1): the smallest
+  {
+    return c_[0];
+  }
+
+  void Merge (PriorityQueue&& other)
+  // push every element of other; other is left empty
+  {
+    if (&other == this) return;
+    for (size_t i = 0; i < other.c_.Size(); ++i)
+      Push(other.c_[i]);
+    other.Clear();
+  }
+
+  void Clear ()
+  {
+    c_.Clear();
+  }
+
+  bool Empty () const
+  {
+    return c_.Empty();
+  }
+
+  size_t Size () const
+  {
+    return c_.Size();
+  }
+
+  const P& GetPredicate() const
+  {
+    return p_;
+  }
+
+  void Dump (std::ostream& os, char ofc = '\0') const
+  {
+    c_.Display(os,ofc);
+  }
+ };
+} // namespace pq16
+
+
+namespace pq17
+{
+ template <typename T, class P >
+ class PriorityQueue
+ {
+  typedef typename fsu::Vector < T >             ContainerType;
+  typedef T                                      ValueType;
+  typedef P                                      PredicateType;
+
+  // min-max heap (Atkinson et al. 1986): a binary heap whose even levels
+  // (root at level 0) are min levels and odd levels max levels; an
+  // element on a min level is the smallest of its subtree, one on a max
+  // level the largest
+  // Push(t)  : append; if t is on the wrong side of its parent, swap;
+  //            then bubble up through grandparents on its own kind of level
+  // FrontMin(): c_[0]       Front(): the larger of c_[1], c_[2]
+  // PopMin() : last element to the root, trickle down: the smallest of
+  //            the children and grandchildren comes up, with a swap when
+  //            the moved element passes a max level parent
+  // Pop()    : the same from the larger child of the root
+  // both ends O(log n)
+
+  PredicateType  p_;
+  ContainerType  c_;
+
+  static bool MinLevel (size_t i)
+  {
+    size_t l = 0;
+    for (++i; i > 1; i >>= 1) ++l;
+    return (l & 1) == 0;
+  }
+
+  bool Before (size_t i, size_t j, bool min) const
+  // c_[i] belongs above c_[j] on a min (max) level
+  {
+    return min ? p_(c_[i], c_[j]) : p_(c_[j], c_[i]);
+  }
+
+  void BubbleUp (size_t i, bool min)
+  {
+    while (i > 2)
+    {
+      size_t g = ((i - 1) / 2 - 1) / 2;
+      if (!Before(i, g, min)) break;
+      fsu::Swap(c_[i], c_[g]);
+      i = g;
+    }
+  }
+
+  void TrickleDown (size_t i, bool min)
+  {
+    size_t n = c_.Size();
+    while (2 * i + 1 < n)
+    {
+      size_t m = 2 * i + 1;                     // best child or grandchild
+      size_t last = 4 * i + 6 < n ? 4 * i + 6 : n - 1;
+      for (size_t j = 2 * i + 2; j <= last; ++j)
+      {
+        if (j == 2 * i + 3) j = 4 * i + 3;      // children, then grandchildren
+        if (j > last) break;
+        if (Before(j, m, min)) m = j;
+      }
+      if (!Before(m, i, min)) return;
+      fsu::Swap(c_[m], c_[i]);
+      if (m <= 2 * i + 2) return;               // a child: its subtree is a leaf level
+      size_t q = (m - 1) / 2;
+      if (Before(q, m, min))
+        fsu::Swap(c_[m], c_[q]);
+      i = m;
+    }
+  }
+
+  size_t MaxIndex () const
+  {
+    size_t n = c_.Size();
+    if (n < 2) return 0;
+    if (n == 2 || !p_(c_[1], c_[2])) return 1;
+    return 2;
+  }
+
+  void Remove (size_t i, bool min)
+  {
+    size_t n = c_.Size() - 1;
+    c_[i] = c_[n];
+    c_.PopBack();
+    if (i < n) TrickleDown(i, min);
+  }
+
+ public:
+  PriorityQueue() : p_(), c_()
+  {}
+
+  explicit PriorityQueue(P p) : p_(p), c_()
+  {}
+
+  void Push (const T& t)
+  // O(log n)
+  {
+    size_t i = c_.Size();
+    c_.PushBack(t);
+    if (i == 0) return;
+    size_t q = (i - 1) / 2;
+    bool min = MinLevel(i);
+    if (Before(q, i, min))                      // t belongs on the other kind of level
+    {
+      fsu::Swap(c_[i], c_[q]);
+      BubbleUp(q, !min);
+    }
+    else
+      BubbleUp(i, min);
+  }
+
+  void Pop ()
+  // O(log n): the largest
+  {
+    size_t i = MaxIndex();
+    Remove(i, i == 0);
+  }
+
+  void PopMin ()
+  // O(log n): the smallest
+  {
+    Remove(0, true);
+  }
+
+  const T& Front () const
+  // O(1): the largest
+  {
+    return c_[MaxIndex()];
+  }
+
+  const T& FrontMin () const
+  // O(1): the smallest
+  {
+    return c_[0];
+  }
+
+  void Merge (PriorityQueue&& other)
+  // push every element of other; other is left empty
+  {
+    if (&other == this) return;
+    for (size_t i = 0; i < other.c_.Size(); ++i)
+      Push(other.c_[i]);
+    other.Clear();
+  }
+
+  void Clear ()
+  {
+    c_.Clear();
+  }
+
+  bool Empty () const
+  {
+    return c_.Empty();
+  }
+
+  size_t Size () const
+  {
+    return c_.Size();
+  }
+
+  const P& GetPredicate() const
+  {
+    return p_;
+  }
+
+  void Dump (std::ostream& os, char ofc = '\0') const
+  {
+    c_.Display(os,ofc);
+  }
+ };
+} // namespace pq17
+
+
+namespace pq18
+{
+ template <typename T, class P >
+ class PriorityQueue
+ {
+  typedef T                                      ValueType;
+  typedef P                                      PredicateType;
+  typedef unsigned long long                     WordType;
+
+  // integer keys: a bit trie over 32-bit keys, in the manner of a van Emde
+  // Boas tree cut into two halves of 16 bits
+  // T is an integer type whose values fit in 32 bits (signed or not); P
+  // must order them as operator < does or as operator > does (checked,
+  // with assert, from p(0, 1) and p(1, 0) when the queue is made); for >
+  // every key is stored complemented, flip_, so that Front() is still the
+  // largest under P
+  // Set16: a multiset of 16-bit values in three levels of 64-way bitmaps:
+  //   top_     bit v  : block v (values 4096v ..) non-empty
+  //   mid_[v]  bit w  : word w of block v non-empty
+  //   leaf_[v][w] bit b: value 4096v + 64w + b present
+  //   a block (64 words) is allocated on its first value and freed with
+  //   its last; copies of a value beyond the first are counted in
+  //   extra_[v], allocated on the first copy
+  //   Max, Min, Next, Prev: one count-leading/trailing-zeros per level
+  // key k: hi = k >> 16 chooses a cluster, lo = k & 0xFFFF a value in it
+  //   hi_ is the Set16 of the non-empty clusters; a cluster is allocated
+  //   on its first key and freed with its last
+  //   c_ holds a pointer per cluster from base_ to the highest in use; it
+  //   grows, at least doubling, to take in a cluster beyond either end,
+  //   and is released by Clear
+  // Push(t), Erase(t), Successor(t), Predecessor(t): a constant number
+  //   of word operations, O(log log U) for U = 2^32
+  // Front(): the largest key, kept in max_; Pop(): Erase(Front())
+  // memory is about 0.6 KB per 4096-key block in use, plus the table c_:
+  // 8 bytes per cluster between the lowest and the highest in use, up to
+  // 512 KB for keys spread over all 2^32; the trie suits keys that are
+  // dense somewhere (ids, deadlines), not ones spread over 2^32
+
+  class Set16
+  {
+   public:
+    Set16 () : top_(0)
+    {
+      for (size_t v = 0; v < 16; ++v)
+      {
+        mid_[v] = 0;
+        leaf_[v] = 0;
+        extra_[v] = 0;
+      }
+    }
+
+    Set16 (const Set16& s) : top_(s.top_)
+    {
+      for (size_t v = 0; v < 16; ++v)
+      {
+        mid_[v] = s.mid_[v];
+        leaf_[v] = s.leaf_[v] ? new WordType[64] : 0;
+        extra_[v] = s.extra_[v] ? new unsigned[4096] : 0;
+        for (size_t w = 0; leaf_[v] && w < 64; ++w)    leaf_[v][w] = s.leaf_[v][w];
+        for (size_t x = 0; extra_[v] && x < 4096; ++x) extra_[v][x] = s.extra_[v][x];
+      }
+    }
+
+    ~Set16 ()
+    {
+      for (size_t v = 0; v < 16; ++v)
+      {
+        delete [] leaf_[v];
+        delete [] extra_[v];
+      }
+    }
+
+    bool Empty () const
+    {
+      return top_ == 0;
+    }
+
+    size_t Count (size_t x) const
+    {
+      const WordType* l = leaf_[x >> 12];
+      if (l == 0 || ((l[(x >> 6) & 63] >> (x & 63)) & 1) == 0) return 0;
+      return 1 + (extra_[x >> 12] ? extra_[x >> 12][x & 4095] : 0);
+    }
+
+    void Insert (size_t x)
+    {
+      size_t v = x >> 12, w = (x >> 6) & 63;
+      WordType b = WordType(1) << (x & 63);
+      if (leaf_[v] == 0)
+      {
+        leaf_[v] = new WordType[64];
+        for (size_t i = 0; i < 64; ++i) leaf_[v][i] = 0;
+      }
+      else if (leaf_[v][w] & b)
+      {
+        if (extra_[v] == 0)
+        {
+          extra_[v] = new unsigned[4096];
+          for (size_t i = 0; i < 4096; ++i) extra_[v][i] = 0;
+        }
+        ++extra_[v][x & 4095];
+        return;
+      }
+      leaf_[v][w] |= b;
+      mid_[v]     |= WordType(1) << w;
+      top_        |= WordType(1) << v;
+    }
+
+    void Remove (size_t x)
+    // one copy of x, which is present
+    {
+      size_t v = x >> 12, w = (x >> 6) & 63;
+      if (extra_[v] != 0 && extra_[v][x & 4095] != 0)
+      {
+        --extra_[v][x & 4095];
+        return;
+      }
+      if ((leaf_[v][w] &= ~(WordType(1) << (x & 63))) != 0) return;
+      if ((mid_[v] &= ~(WordType(1) << w)) != 0) return;
+      top_ &= ~(WordType(1) << v);
+      delete [] leaf_[v];
+      delete [] extra_[v];
+      leaf_[v] = 0;
+      extra_[v] = 0;
+    }
+
+    size_t Max () const
+    // non-empty
+    {
+      size_t v = High(top_), w = High(mid_[v]);
+      return (v << 12) + (w << 6) + High(leaf_[v][w]);
+    }
+
+    size_t Min () const
+    // non-empty
+    {
+      size_t v = Low(top_), w = Low(mid_[v]);
+      return (v << 12) + (w << 6) + Low(leaf_[v][w]);
+    }
+
+    bool Next (size_t x, size_t& y) const
+    // smallest value > x
+    {
+      if (++x > 0xFFFF) return false;
+      size_t v = x >> 12, w = (x >> 6) & 63;
+      WordType m = leaf_[v] ? leaf_[v][w] & (~WordType(0) << (x & 63)) : 0;
+      if (m == 0)
+      {
+        m = w == 63 ? 0 : mid_[v] & (~WordType(0) << (w + 1));
+        if (m == 0)
+        {
+          m = top_ & (~WordType(0) << v) & ~(WordType(1) << v);
+          if (m == 0) return false;
+          v = Low(m);
+          m = mid_[v];
+        }
+        w = Low(m);
+        m = leaf_[v][w];
+      }
+      y = (v << 12) + (w << 6) + Low(m);
+      return true;
+    }
+
+    bool Prev (size_t x, size_t& y) const
+    // largest value < x
+    {
+      if (x-- == 0) return false;
+      size_t v = x >> 12, w = (x >> 6) & 63;
+      WordType m = leaf_[v] ? leaf_[v][w] & (~WordType(0) >> (63 - (x & 63))) : 0;
+      if (m == 0)
+      {
+        m = mid_[v] & ((WordType(1) << w) - 1);
+        if (m == 0)
+        {
+          m = top_ & ((WordType(1) << v) - 1);
+          if (m == 0) return false;
+          v = High(m);
+          m = mid_[v];
+        }
+        w = High(m);
+        m = leaf_[v][w];
+      }
+      y = (v << 12) + (w << 6) + High(m);
+      return true;
+    }
+
+   private:
+    WordType  top_;
+    WordType  mid_[16];
+    WordType* leaf_[16];
+    unsigned* extra_[16];
+
+    static size_t Low  (WordType w) { return __builtin_ctzll(w); }
+    static size_t High (WordType w) { return 63 - __builtin_clzll(w); }
+
+    Set16& operator = (const Set16&);
+  };
+
+  typedef fsu::Vector < Set16* >                 ContainerType;
+
+  PredicateType  p_;
+  Set16          hi_;
+  ContainerType  c_;      // c_[i] is cluster base_ + i, or 0 if it is empty
+  size_t         base_;
+  size_t         size_;
+  T              max_;
+  unsigned long  flip_;   // 0 if P is <, 0xFFFFFFFF if P is >
+
+  static unsigned long Direction (const P& p)
+  {
+    bool less = p(T(0), T(1)), greater = p(T(1), T(0));
+    assert(less != greater && "pq18: P must order keys as < or > does");
+    return greater ? 0xFFFFFFFFUL : 0;
+  }
+
+  unsigned long Key (T t) const
+  {
+    unsigned long k = static_cast<unsigned long>(t) & 0xFFFFFFFFUL;
+    return (std::is_signed<T>::value ? k ^ 0x80000000UL : k) ^ flip_;
+  }
+
+  T Value (unsigned long k) const
+  {
+    k ^= flip_;
+    if (std::is_signed<T>::value)
+      return static_cast<T>(static_cast<int>(static_cast<unsigned int>(k ^ 0x80000000UL)));
+    return static_cast<T>(k);
+  }
+
+  T Value (size_t h, size_t l) const
+  {
+    return Value((static_cast<unsigned long>(h) << 16) | l);
+  }
+
+  Set16* Find (size_t h) const
+  // cluster h; 0 if it is empty or outside the table
+  {
+    return h - base_ < c_.Size() ? c_[h - base_] : 0;
+  }
+
+  Set16*& Slot (size_t h)
+  // the table entry of cluster h, growing the table to take it in; the
+  // range at least doubles, so the copying is O(1) amortized per entry
+  {
+    size_t n = c_.Size();
+    if (n == 0)
+    {
+      base_ = h;
+      c_.PushBack(0);
+    }
+    else if (h - base_ >= n)
+    {
+      size_t lo = base_, hi = base_ + n;
+      if (h < lo)
+      {
+        lo = lo > n ? lo - n : 0;
+        if (h < lo) lo = h;
+      }
+      else
+      {
+        hi = hi + n < 65536 ? hi + n : 65536;
+        if (h >= hi) hi = h + 1;
+      }
+      ContainerType t;
+      for (size_t i = lo; i < hi; ++i)
+        t.PushBack(Find(i));
+      c_ = t;
+      base_ = lo;
+    }
+    return c_[h - base_];
+  }
+
+  void Copy (const PriorityQueue& q)
+  {
+    size_ = q.size_;
+    max_ = q.max_;
+    base_ = q.base_;
+    c_.Clear();
+    for (size_t i = 0; i < q.c_.Size(); ++i)
+    {
+      c_.PushBack(q.c_[i] != 0 ? new Set16(*q.c_[i]) : 0);
+      if (q.c_[i] != 0) hi_.Insert(base_ + i);
+    }
+  }
+
+  void Free ()
+  {
+    while (!hi_.Empty())
+    {
+      size_t h = hi_.Min();
+      delete c_[h - base_];
+      hi_.Remove(h);
+    }
+    c_.Clear();
+    base_ = 0;
+  }
+
+ public:
+  PriorityQueue() : p_(), hi_(), c_(), base_(0), size_(0), max_(), flip_(Direction(p_))
+  {}
+
+  explicit PriorityQueue(P p) : p_(p), hi_(), c_(), base_(0), size_(0), max_(), flip_(Direction(p_))
+  {}
+
+  PriorityQueue(const PriorityQueue& q) : p_(q.p_), hi_(), c_(), base_(0), size_(0), max_(), flip_(q.flip_)
+  {
+    Copy(q);
+  }
+
+  PriorityQueue& operator = (const PriorityQueue& q)
+  {
+    if (this != &q)
+    {
+      Free();
+      p_ = q.p_;
+      flip_ = q.flip_;
+      Copy(q);
+    }
+    return *this;
+  }
+
+  ~PriorityQueue()
+  {
+    Free();
+  }
+
+  void Push (const T& t)
+  // O(log log U)
+  {
+    unsigned long k = Key(t);
+    size_t h = k >> 16;
+    Set16*& c = Slot(h);
+    if (c == 0)
+    {
+      c = new Set16;
+      hi_.Insert(h);
+    }
+    c->Insert(k & 0xFFFF);
+    if (size_ == 0 || Key(max_) < k) max_ = t;
+    ++size_;
+  }
+
+  bool Erase (const T& t)
+  // remove one copy of t; false if there is none
+  {
+    if (Count(t) == 0) return false;
+    unsigned long k = Key(t);
+    size_t h = k >> 16;
+    Set16*& c = c_[h - base_];
+    c->Remove(k & 0xFFFF);
+    if (c->Empty())
+    {
+      delete c;
+      c = 0;
+      hi_.Remove(h);
+    }
+    if (--size_ > 0 && k == Key(max_) && (c == 0 || c->Count(k & 0xFFFF) == 0))
+    {
+      h = hi_.Max();
+      max_ = Value(h, Find(h)->Max());
+    }
+    return true;
+  }
+
+  size_t Count (const T& t) const
+  // copies of t
+  {
+    unsigned long k = Key(t);
+    const Set16* c = Find(k >> 16);
+    return c ? c->Count(k & 0xFFFF) : 0;
+  }
+
+  bool Successor (const T& t, T& s) const
+  // s = the next key after t in the order of P (the smallest key > t for
+  // operator <); false if there is none
+  {
+    if (size_ == 0) return false;
+    unsigned long k = Key(t);
+    size_t h = k >> 16, l;
+    const Set16* c = Find(h);
+    if (c != 0 && c->Next(k & 0xFFFF, l))
+    {
+      s = Value(h, l);
+      return true;
+    }
+    if (!hi_.Next(h, h)) return false;
+    s = Value(h, Find(h)->Min());
+    return true;
+  }
+
+  bool Predecessor (const T& t, T& s) const
+  // s = the key before t in the order of P (the largest key < t for
+  // operator <); false if there is none
+  {
+    if (size_ == 0) return false;
+    unsigned long k = Key(t);
+    size_t h = k >> 16, l;
+    const Set16* c = Find(h);
+    if (c != 0 && c->Prev(k & 0xFFFF, l))
+    {
+      s = Value(h, l);
+      return true;
+    }
+    if (!hi_.Prev(h, h)) return false;
+    s = Value(h, Find(h)->Max());
+    return true;
+  }
+
+  void Pop ()
+  // O(log log U)
+  {
+    Erase(max_);
+  }
+
+  const T& Front () const
+  // O(1)
+  {
+    return max_;
+  }
+
+  void Merge (PriorityQueue&& other)
+  // push every key of other; other is left empty
+  {
+    if (&other == this) return;
+    while (!other.Empty())
+    {
+      Push(other.Front());
+      other.Pop();
+    }
+  }
+
+  void Clear ()
+  {
+    Free();
+    size_ = 0;
+  }
+
+  bool Empty () const
+  {
+    return size_ == 0;
+  }
+
+  size_t Size () const
+  {
+    return size_;
+  }
+
+  const P& GetPredicate() const
+  {
+    return p_;
+  }
+
+  void Dump (std::ostream& os, char ofc = '\0') const
+  // keys in increasing order under P
+  {
+    if (size_ == 0) return;
+    size_t h = hi_.Min();
+    while (true)
+    {
+      const Set16* c = Find(h);
+      size_t l = c->Min();
+      while (true)
+      {
+        for (size_t n = c->Count(l); n > 0; --n)
+        {
+          os << Value(h, l);
+          if (ofc != '\0') os << ofc;
+        }
+        if (!c->Next(l, l)) break;
+      }
+      if (!hi_.Next(h, h)) break;
+    }
+  }
+ };
+} // namespace pq18
+
+
+namespace pq19
+{
+ template <typename T, class P, size_t B = 4096, class C = fsu::Vector < T > >
+ class PriorityQueue
+ {
+  typedef C                                      ContainerType;
+  typedef T                                      ValueType;
+  typedef P                                      PredicateType;
+
+  // B-heap (Kamp 2010): a binary heap laid out so that a path from the
+  // root to a leaf touches about log n / log E pages of B bytes instead
+  // of log n; E is the largest power of 2 with E elements in B bytes
+  // the array is cut into pages of E slots; slot 0 of a page is unused
+  // and slots 1 .. E-1 hold a complete binary subtree in heap order:
+  //   children of slot s are slots 2s and 2s+1 while 2s < E
+  // the E/2 slots on the last level of page p have 2 child pages each,
+  // numbered pE + 1 .. pE + E: slot E/2 + j of page p parents slot 1 of
+  // pages pE + 1 + 2j and pE + 2 + 2j
+  // pages are filled in order, so every parent comes before its children
+  // in the array, and the last element is a leaf: Push and Pop append
+  // and remove at the end exactly as in pq6 (hole-based SiftUp, bottom-up
+  // Pop), only with different parent and child arithmetic
+  // the depth is at most that of pq6 plus the height of one page
+
+  static constexpr size_t Slots (size_t e)
+  {
+    return (e * 2 * sizeof(T) <= B) ? Slots(e * 2) : e;
+  }
+
+  static constexpr size_t Log2 (size_t e)
+  {
+    return e <= 1 ? 0 : 1 + Log2(e / 2);
+  }
+
+  static const size_t E = Slots(4);              // slots per page, at least 4
+  static const size_t L = Log2(E);               // E == 1 << L
+
+  PredicateType  p_;
+  ContainerType  c_;       // c_[0] unused, as is every slot 0
+  size_t         size_;
+
+  static size_t Parent (size_t x)
+  {
+    size_t p = x >> L, s = x & (E - 1);
+    if (s > 1) return (p << L) | (s >> 1);
+    --p;
+    return ((p >> L) << L) | (E / 2 + ((p & (E - 1)) >> 1));
+  }
+
+  static size_t Left (size_t x, size_t& step)
+  // first child; the second is first + step
+  {
+    size_t p = x >> L, s = x & (E - 1);
+    if (2 * s < E)
+    {
+      step = 1;
+      return (p << L) | (2 * s);
+    }
+    step = E;
+    return ((p * E + 1 + 2 * (s - E / 2)) << L) | 1;
+  }
+
+  void SiftUp (size_t x, T t)
+  {
+    while (x != 1)
+    {
+      size_t q = Parent(x);
+      if (!p_(c_[q], t)) break;
+      c_[x] = c_[q];
+      x = q;
+    }
+    c_[x] = t;
+  }
+
+ public:
+  PriorityQueue() : p_(), c_(), size_(0)
+  {}
+
+  explicit PriorityQueue(P p) : p_(p), c_(), size_(0)
+  {}
+
+  void Push (const T& t)
+  // O(log n), O(log n / log E) pages
+  {
+    if ((c_.Size() & (E - 1)) == 0)
+      c_.PushBack(T());      // slot 0 of a new page
+    c_.PushBack(t);
+    ++size_;
+    SiftUp(c_.Size() - 1, t);
+  }
+
+  void Pop ()
+  // O(log n), O(log n / log E) pages
+  {
+    T t = c_.Back();
+    c_.PopBack();
+    if ((c_.Size() & (E - 1)) == 1)
+      c_.PopBack();          // slot 0 of an emptied page
+    if (--size_ == 0) return;
+    // Floyd: the hole goes down along the larger children to a leaf,
+    // then t goes up from there
+    size_t n = c_.Size(), x = 1, step;
+    for (size_t c = Left(x, step); c < n; c = Left(x, step))
+    {
+      if (c + step < n && p_(c_[c], c_[c + step]))
+        c += step;
+      c_[x] = c_[c];
+      x = c;
+    }
+    SiftUp(x, t);
+  }
+
+  const T& Front () const
+  // O(1)
+  {
+    return c_[1];
+  }
+
+  void Merge (PriorityQueue&& other)
+  // push every element of other; other is left empty
+  {
+    if (&other == this) return;
+    for (size_t x = 0; x < other.c_.Size(); ++x)
+      if ((x & (E - 1)) != 0) Push(other.c_[x]);
+    other.Clear();
+  }
+
+  void Clear ()
+  {
+    c_.Clear();
+    size_ = 0;
+  }
+
+  bool Empty () const
+  {
+    return size_ == 0;
+  }
+
+  size_t Size () const
+  {
+    return size_;
+  }
+
+  static size_t PageSlots ()
+  {
+    return E;
+  }
+
+  const P& GetPredicate() const
+  {
+    return p_;
+  }
+
+  const C& GetContainer() const
+  // the container itself, to inspect (its backing, for a pqh::Vector)
+  {
+    return c_;
+  }
+
+  void Dump (std::ostream& os, char ofc = '\0') const
+  // array order, without the unused slots
+  {
+    for (size_t x = 0; x < c_.Size(); ++x)
+    {
+      if ((x & (E - 1)) == 0) continue;
+      os << c_[x];
+      if (ofc != '\0') os << ofc;
+    }
+  }
+ };
+} // namespace pq19
+
+#endif
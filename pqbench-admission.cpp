@@ -0,0 +1,80 @@
+/*
+    pqbench-admission.cpp
+
+    Double-ended workload of an admission controller: requests arrive with
+    random priorities into a queue of at most n; when it is full the
+    lowest priority request is shed (PopMin) before the new one is
+    admitted, and after every arrival the highest priority request is
+    served (Pop) with probability 1/2. Compares pq16 (interval heap),
+    pq17 (min-max heap) and pq5 (sorted MOVector, O(n) Push).
+
+    usage: pqbench-admission.x [n] [arrivals]
+       n         queue capacity; pq5 at most 10000      (default 1000)
+       arrivals  requests offered                       (default 1000000)
+
+    All queues must report the same checksum.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <chrono>
+
+#include <compare.h>   // generic lessthan and greaterthan predicates
+#include <pq.h>
+#include <pqbench.h>
+
+typedef unsigned long long            Key;
+typedef fsu::LessThan < Key >         PredicateType;
+
+template < class Q >
+void Run (const char* implementation, size_t n, size_t arrivals)
+{
+  pqb::Random r(4530);
+  Q q;
+  Key checksum = 0;
+  size_t served = 0, shed = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < arrivals; ++i)
+  {
+    Key k = r.Next();
+    if (q.Size() == n)
+    {
+      checksum = checksum * 31 + q.FrontMin();
+      q.PopMin();
+      ++shed;
+    }
+    q.Push(k >> 1);
+    if (k & 1)
+    {
+      checksum = checksum * 37 + q.Front();
+      q.Pop();
+      ++served;
+    }
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  std::cout << std::left << std::setw(24) << implementation << std::right
+            << std::fixed << std::setprecision(1)
+            << std::setw(10) << 1e9 * elapsed.count() / arrivals << " ns/arrival"
+            << std::setw(10) << served << " served" << std::setw(10) << shed << " shed"
+            << "   checksum " << checksum << '\n';
+}
+
+int main(int argc, char* argv[])
+{
+  size_t n        = (argc > 1) ? std::strtoul(argv[1], 0, 10) : 1000;
+  size_t arrivals = (argc > 2) ? std::strtoul(argv[2], 0, 10) : 1000000;
+  if (n == 0)
+  {
+    std::cout << "n must be positive - try again\n";
+    return EXIT_FAILURE;
+  }
+  std::cout << "capacity " << n << ", " << arrivals << " arrivals\n";
+  Run < pq16::PriorityQueue < Key , PredicateType > > ("pq16: interval heap", n, arrivals);
+  Run < pq17::PriorityQueue < Key , PredicateType > > ("pq17: min-max heap", n, arrivals);
+  // pq5 pushes are O(n): at most 10000 elements
+  if (n <= 10000)
+    Run < pq5::PriorityQueue < Key , PredicateType > > ("pq5: MOVector, Insert()", n, arrivals);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,382 @@
+/*
+    pqbench-all.cpp
+
+    Measured cost of every PriorityQueue in pq.h (through pqpolicy.h) on a
+    set of named workloads, so that implementations can be chosen from
+    numbers on the machine at hand rather than from the complexity table.
+
+    workload   operations (n = size)
+    --------   ----------
+    random     n/2 pushes, n random pushes/pops (pop only when non-empty),
+               then drain
+    hold       n pushes, n holds (pop the front f, push f - x with x drawn
+               from an exponential distribution), then drain
+    sorted     n pushes of increasing keys, then drain
+    reverse    n pushes of decreasing keys, then drain
+    dups       n pushes of keys in [0,16), then drain
+    sawtooth   4 teeth: push up to n, pop down to n/8; then drain
+    trace      the commands of a fpq command file (+ - F C) repeated
+               "scale" times, then drain
+
+    Every (queue, workload) pair runs in a child process, so that peak RSS
+    (getrusage) belongs to that run alone; it still includes the operation
+    array of the workload, which is the same for every queue. Comparisons
+    are counted by the predicate; pq7, pq8 and pq18 order by a key function
+    or by the bits of the key and report none. pq7 runs only where every
+    key is a valid level: "dups", and "sorted" and "reverse" for a size
+    below 256. pq18 runs only where every key fits in 32 bits: "dups",
+    "sorted" and "reverse". pq12 has a fixed capacity and is measured by
+    pqbench-static.x.
+
+    usage: pqbench-all.x [csv|json] [size] [trace file] [scale]
+       csv|json    output format                   (default csv)
+       size        n above                         (default 10000)
+       trace file  fpq command file                (default fpq.com1)
+       scale       repetitions of the trace        (default 1000)
+
+    pq1 - pq5 have O(n) operations: keep size modest when they are included.
+    All queues must report the same checksum for each workload.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+
+#include <sys/resource.h>  // getrusage()
+#include <sys/wait.h>      // waitpid()
+#include <unistd.h>        // fork(), _exit()
+
+#include <vector.h>
+#include <pq.h>
+#include <pqpolicy.h>
+#include <pqbench.h>
+
+typedef unsigned long long Key;
+
+// ----------------------------------------------------------------------
+// predicate and key functions
+
+unsigned long long compares = 0;
+
+class CountingLess
+{
+public:
+  bool operator () (const Key& a, const Key& b) const
+  {
+    ++compares;
+    return a < b;
+  }
+};
+
+class Level      // pq7: the key is the level
+{
+public:
+  size_t operator () (Key k) const { return static_cast<size_t>(k); }
+};
+
+class EventTime  // pq8 pops the earliest time: larger keys are earlier
+{
+public:
+  double operator () (Key k) const { return -static_cast<double>(k); }
+};
+
+class Identity   // pq11: the key is the element
+{
+public:
+  Key operator () (Key k) const { return k; }
+};
+
+// ----------------------------------------------------------------------
+// workloads
+
+struct Op
+{
+  char kind_;    // '+' push, '-' pop, 'F' front, 'H' hold, 'C' clear
+  Key  key_;     // pushed key, or hold decrement
+};
+
+struct Workload
+{
+  const char*       name_;
+  fsu::Vector < Op > op_;
+  Key               range_;   // all keys < range_, or 0 if unbounded
+};
+
+const Key Base = Key(1) << 50;   // keys stay exact as doubles (pq8)
+
+void Add (Workload& w, char kind, Key key = 0)
+{
+  Op op;
+  op.kind_ = kind;
+  op.key_ = key;
+  w.op_.PushBack(op);
+}
+
+void Drain (Workload& w, size_t size)
+{
+  for (size_t i = 0; i < size; ++i)
+    Add(w, '-');
+}
+
+void Build (fsu::Vector < Workload > & ws, size_t n, const char* traceFile, size_t scale)
+{
+  pqb::Random r(4530);
+  Workload w;
+
+  w.name_ = "random"; w.op_.Clear(); w.range_ = 0;
+  size_t size = 0;
+  for (size_t i = 0; i < n / 2; ++i, ++size)
+    Add(w, '+', r.Next(Base));
+  for (size_t i = 0; i < n; ++i)
+  {
+    if (size > 0 && r.Next(2) == 0) { Add(w, '-'); --size; }
+    else                            { Add(w, '+', r.Next(Base)); ++size; }
+  }
+  Drain(w, size);
+  ws.PushBack(w);
+
+  w.name_ = "hold"; w.op_.Clear(); w.range_ = 0;
+  for (size_t i = 0; i < n; ++i)
+    Add(w, '+', Base - r.Next(Key(1) << 30));
+  for (size_t i = 0; i < n; ++i)
+    Add(w, 'H', static_cast<Key>(1024 * r.Exponential()));
+  Drain(w, n);
+  ws.PushBack(w);
+
+  w.name_ = "sorted"; w.op_.Clear(); w.range_ = n + 1;
+  for (size_t i = 0; i < n; ++i)
+    Add(w, '+', i);
+  Drain(w, n);
+  ws.PushBack(w);
+
+  w.name_ = "reverse"; w.op_.Clear(); w.range_ = n + 1;
+  for (size_t i = 0; i < n; ++i)
+    Add(w, '+', n - i);
+  Drain(w, n);
+  ws.PushBack(w);
+
+  w.name_ = "dups"; w.op_.Clear(); w.range_ = 16;
+  for (size_t i = 0; i < n; ++i)
+    Add(w, '+', r.Next(16));
+  Drain(w, n);
+  ws.PushBack(w);
+
+  w.name_ = "sawtooth"; w.op_.Clear(); w.range_ = 0;
+  size = 0;
+  for (size_t tooth = 0; tooth < 4; ++tooth)
+  {
+    for (; size < n; ++size)
+      Add(w, '+', r.Next(Base));
+    for (; size > n / 8; --size)
+      Add(w, '-');
+  }
+  Drain(w, size);
+  ws.PushBack(w);
+
+  std::ifstream ifs(traceFile);
+  if (ifs.fail())
+  {
+    std::cerr << "cannot open trace file " << traceFile << " - trace workload skipped\n";
+    return;
+  }
+  Workload t;
+  t.name_ = "trace"; t.range_ = 0;
+  char option;
+  char name[256];
+  long priority;
+  while (ifs >> option)
+  {
+    switch (option)
+    {
+      case '+': case '1':
+        ifs >> std::setw(sizeof(name)) >> name >> priority;
+        Add(t, '+', Base + priority);
+        break;
+      case '-': case '2': Add(t, '-'); break;
+      case 'f': case 'F': Add(t, 'F'); break;
+      case 'c': case 'C': Add(t, 'C'); break;
+      default: break;      // E S D M X Q do not touch the queue
+    }
+  }
+  w.name_ = "trace"; w.op_.Clear(); w.range_ = 0;
+  size = 0;
+  for (size_t k = 0; k < scale; ++k)
+  {
+    for (size_t i = 0; i < t.op_.Size(); ++i)
+    {
+      w.op_.PushBack(t.op_[i]);
+      if (t.op_[i].kind_ == '+')      ++size;
+      else if (t.op_[i].kind_ == 'C') size = 0;
+      else if (t.op_[i].kind_ == '-' && size > 0) --size;
+    }
+  }
+  Drain(w, size);
+  ws.PushBack(w);
+}
+
+// ----------------------------------------------------------------------
+// measurement
+
+bool json  = false;
+bool first = true;
+
+template < class Policy >
+void Time (const char* nmsp, const Workload& w, bool counted)
+{
+  typedef pqp::PriorityQueue < Key , CountingLess , Policy > Queue;
+  Queue q;
+  Key checksum = 0;
+  compares = 0;
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < w.op_.Size(); ++i)
+  {
+    const Op& op = w.op_[i];
+    switch (op.kind_)
+    {
+      case '+':
+        q.Push(op.key_);
+        break;
+      case '-':
+        if (!q.Empty())
+        {
+          checksum = checksum * 31 + q.Front();
+          q.Pop();
+        }
+        break;
+      case 'F':
+        if (!q.Empty())
+          checksum += q.Front();
+        break;
+      case 'H':
+        {
+          Key f = q.Front();
+          q.Pop();
+          checksum = checksum * 31 + f;
+          q.Push(f - op.key_);
+        }
+        break;
+      case 'C':
+        q.Clear();
+        break;
+    }
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  size_t ops = w.op_.Size();
+  double seconds = elapsed.count();
+  double nsPerOp = 1e9 * seconds / ops;
+  double mops = ops / seconds / 1e6;
+
+  if (json)
+  {
+    std::cout << "  { \"queue\": \"" << nmsp << "\", \"implementation\": \"" << Queue::Implementation()
+              << "\", \"workload\": \"" << w.name_ << "\", \"ops\": " << ops
+              << std::fixed << std::setprecision(6) << ", \"seconds\": " << seconds
+              << std::setprecision(2) << ", \"ns_per_op\": " << nsPerOp
+              << ", \"mops_per_s\": " << mops
+              << ", \"peak_rss_kib\": " << usage.ru_maxrss
+              << ", \"comparisons\": ";
+    if (counted) std::cout << compares << ", \"comparisons_per_op\": " << static_cast<double>(compares) / ops;
+    else         std::cout << "null, \"comparisons_per_op\": null";
+    std::cout << ", \"checksum\": " << checksum << " }";
+  }
+  else
+  {
+    std::cout << nmsp << ",\"" << Queue::Implementation() << "\"," << w.name_ << ',' << ops
+              << std::fixed << std::setprecision(6) << ',' << seconds
+              << std::setprecision(2) << ',' << nsPerOp << ',' << mops
+              << ',' << usage.ru_maxrss << ',';
+    if (counted) std::cout << compares << ',' << static_cast<double>(compares) / ops;
+    else         std::cout << ',';
+    std::cout << ',' << checksum << '\n';
+  }
+  std::cout.flush();
+}
+
+template < class Policy >
+void Measure (const char* nmsp, const Workload& w, bool counted = true)
+// one child process per run
+{
+  if (json)
+  {
+    std::cout << (first ? "" : ",\n");
+    first = false;
+  }
+  std::cout.flush();
+  pid_t pid = fork();
+  if (pid == 0)
+  {
+    Time < Policy > (nmsp, w, counted);
+    _exit(EXIT_SUCCESS);
+  }
+  if (pid < 0)
+  {
+    Time < Policy > (nmsp, w, counted);   // no fork: RSS is cumulative
+    return;
+  }
+  int status;
+  waitpid(pid, &status, 0);
+}
+
+int main(int argc, char* argv[])
+{
+  json              = (argc > 1) && std::strcmp(argv[1], "json") == 0;
+  size_t size       = (argc > 2) ? std::strtoul(argv[2], 0, 10) : 10000;
+  const char* trace = (argc > 3) ? argv[3] : "fpq.com1";
+  size_t scale      = (argc > 4) ? std::strtoul(argv[4], 0, 10) : 1000;
+  if (argc > 1 && !json && std::strcmp(argv[1], "csv") != 0)
+  {
+    std::cout << "format must be csv or json - try again\n";
+    return EXIT_FAILURE;
+  }
+  if (size == 0)
+  {
+    std::cout << "size must be positive - try again\n";
+    return EXIT_FAILURE;
+  }
+
+  fsu::Vector < Workload > ws;
+  Build(ws, size, trace, scale);
+
+  if (json)
+    std::cout << "[\n";
+  else
+    std::cout << "queue,implementation,workload,ops,seconds,ns_per_op,mops_per_s,"
+              << "peak_rss_kib,comparisons,comparisons_per_op,checksum\n";
+
+  for (size_t i = 0; i < ws.Size(); ++i)
+  {
+    const Workload& w = ws[i];
+    Measure < pqp::UnorderedList >                      ("pq1",  w);
+    Measure < pqp::SortedList >                         ("pq2",  w);
+    Measure < pqp::DequeSwap >                          ("pq3",  w);
+    Measure < pqp::DequeLeapfrog >                      ("pq4",  w);
+    Measure < pqp::SortedVector >                       ("pq5",  w);
+    Measure < pqp::Heap >                               ("pq6",  w);
+    if (w.range_ != 0 && w.range_ <= 256)
+      Measure < pqp::Bucket < Level , 256 > >           ("pq7",  w, false);
+    Measure < pqp::Calendar < EventTime > >             ("pq8",  w, false);
+    Measure < pqp::SequenceHeap <> >                    ("pq9",  w);
+    Measure < pqp::DaryHeap < 4 > >                     ("pq10", w);
+    Measure < pqp::KeySlot < Identity , CountingLess > > ("pq11", w);
+    Measure < pqp::Adaptive >                           ("pq13", w);
+    Measure < pqp::WeakHeap >                           ("pq14", w);
+    Measure < pqp::Persistent >                         ("pq15", w);
+    Measure < pqp::Interval >                           ("pq16", w);
+    Measure < pqp::MinMax >                             ("pq17", w);
+    if (w.range_ != 0 && w.range_ <= (Key(1) << 32))
+      Measure < pqp::IntTrie >                          ("pq18", w, false);
+    Measure < pqp::BHeap < > >                          ("pq19", w);
+  }
+
+  if (json)
+    std::cout << "\n]\n";
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,191 @@
+/*
+    pqbench-bheap.cpp
+
+    pq19 (B-heap, page-blocked layout) against pq6 (implicit binary heap)
+    on a heap too large for the TLB: the queue is filled with n random
+    keys and then runs "holds" holds (pop the front f, push f - x). Each
+    run is timed and its minor and major page faults counted (getrusage)
+    separately for the fill and the holds.
+
+    Both heaps run in fsu::Vector and in pqh::Vector (hugevec.h), which
+    maps its array 2 MB-aligned with madvise(MADV_HUGEPAGE), from the
+    hugetlbfs pool ("hugetlb" rows, when it has pages) and NUMA-local
+    ("local" rows); the backing obtained and the AnonHugePages of the
+    process (/proc/self/smaps_rollup) are printed after each run.
+
+    Every run is a child process, once as the system leaves it and once
+    with transparent huge pages disabled for the process
+    (prctl(PR_SET_THP_DISABLE)), so that the layout can be compared with
+    and without 2 MB pages; the system THP setting is printed first
+    ("madvise" means no huge pages for a plain heap either way).
+
+    usage: pqbench-bheap.x [n] [holds]
+       n       heap size                             (default 10000000)
+       holds   hold operations                       (default 10000000)
+
+    Both heaps must report the same checksum.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <cstdlib>
+#include <chrono>
+
+#include <sys/prctl.h>     // prctl()
+#include <sys/resource.h>  // getrusage()
+#include <sys/wait.h>      // waitpid()
+#include <unistd.h>        // fork(), _exit()
+
+#include <compare.h>   // generic lessthan and greaterthan predicates
+#include <pq.h>
+#include <hugevec.h>
+#include <pqbench.h>
+
+typedef unsigned long long            Key;
+typedef fsu::LessThan < Key >         PredicateType;
+
+typedef pqh::Vector < Key >                             HugeVector;
+typedef pqh::Vector < Key , pqh::Explicit >             HugeTlbVector;
+typedef pqh::Vector < Key , pqh::Transparent | pqh::Local > LocalVector;
+
+// AnonHugePages of the process, in kB; -1 if the kernel does not say
+long AnonHuge ()
+{
+  std::ifstream smaps("/proc/self/smaps_rollup");
+  std::string field;
+  long kb;
+  while (smaps >> field)
+  {
+    if (field == "AnonHugePages:" && smaps >> kb) return kb;
+    smaps.ignore(256, '\n');
+  }
+  return -1;
+}
+
+const char* Describe (pqh::Backing b)
+{
+  switch (b)
+  {
+    case pqh::Normal:  return "normal";
+    case pqh::Thp:     return "madvise(MADV_HUGEPAGE)";
+    case pqh::HugeTlb: return "hugetlbfs";
+    default:           return "unmapped";
+  }
+}
+
+template < class C >
+void Backing (const C&)
+{
+  std::cout << "    AnonHugePages " << AnonHuge() << " kB\n";
+}
+
+template < typename T , unsigned F >
+void Backing (const pqh::Vector < T , F > & c)
+{
+  std::cout << "    " << Describe(c.GetBacking()) << ", node " << c.GetNode()
+            << ", AnonHugePages " << AnonHuge() << " kB\n";
+}
+
+void Faults (long& minor, long& major)
+{
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  minor = usage.ru_minflt;
+  major = usage.ru_majflt;
+}
+
+template < class Q >
+void Time (const char* implementation, const char* pages, size_t n, size_t holds)
+{
+  pqb::Random r(4530);
+  Q q;
+  Key checksum = 0;
+  long min0, maj0, min1, maj1, min2, maj2;
+  Faults(min0, maj0);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < n; ++i)
+    q.Push(r.Next());
+  std::chrono::steady_clock::time_point filled = std::chrono::steady_clock::now();
+  Faults(min1, maj1);
+  for (size_t i = 0; i < holds; ++i)
+  {
+    Key f = q.Front();
+    checksum = checksum * 31 + f;
+    q.Pop();
+    q.Push(f - (r.Next() & 0xFFFFFF));
+  }
+  std::chrono::steady_clock::time_point held = std::chrono::steady_clock::now();
+  Faults(min2, maj2);
+  std::chrono::duration<double> fill = filled - start;
+  std::chrono::duration<double> hold = held - filled;
+
+  std::cout << std::left << std::setw(18) << implementation << std::setw(8) << pages
+            << std::right << std::fixed << std::setprecision(1)
+            << " fill " << std::setw(7) << 1e9 * fill.count() / n << " ns/op "
+            << std::setw(9) << min1 - min0 << '/' << maj1 - maj0 << " faults"
+            << "  hold " << std::setw(7) << (holds ? 1e9 * hold.count() / holds : 0.0) << " ns/op "
+            << std::setw(7) << min2 - min1 << '/' << maj2 - maj1 << " faults"
+            << "   checksum " << checksum << '\n';
+  Backing(q.GetContainer());
+  std::cout << std::flush;
+}
+
+template < class Q >
+void Run (const char* implementation, size_t n, size_t holds)
+{
+  for (int thp = 1; thp >= 0; --thp)
+  {
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+      if (!thp && prctl(PR_SET_THP_DISABLE, 1, 0, 0, 0) != 0)
+      {
+        std::cout << implementation << ": PR_SET_THP_DISABLE not supported\n";
+        _exit(EXIT_FAILURE);
+      }
+      Time < Q > (implementation, thp ? "thp" : "no thp", n, holds);
+      _exit(EXIT_SUCCESS);
+    }
+    if (pid < 0)
+    {
+      std::cout << "fork failed\n";
+      return;
+    }
+    int status;
+    waitpid(pid, &status, 0);
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  size_t n     = (argc > 1) ? std::strtoul(argv[1], 0, 10) : 10000000;
+  size_t holds = (argc > 2) ? std::strtoul(argv[2], 0, 10) : 10000000;
+  if (n == 0)
+  {
+    std::cout << "n must be positive - try again\n";
+    return EXIT_FAILURE;
+  }
+
+  std::string thp;
+  std::ifstream sys("/sys/kernel/mm/transparent_hugepage/enabled");
+  if (!std::getline(sys, thp)) thp = "unknown";
+  std::cout << "n " << n << ", " << holds << " holds, transparent huge pages: " << thp
+            << "\nB-heap page: " << pq19::PriorityQueue < Key , PredicateType > ::PageSlots()
+            << " slots of " << sizeof(Key) << " bytes\n" << std::endl;
+
+  Run < pq6::PriorityQueue  < Key , PredicateType > >
+      ("pq6: binary heap", n, holds);
+  Run < pq19::PriorityQueue < Key , PredicateType > >
+      ("pq19: B-heap", n, holds);
+  Run < pq6::PriorityQueue  < Key , PredicateType , HugeVector > >
+      ("pq6: huge", n, holds);
+  Run < pq19::PriorityQueue < Key , PredicateType , 4096 , HugeVector > >
+      ("pq19: huge", n, holds);
+  Run < pq6::PriorityQueue  < Key , PredicateType , HugeTlbVector > >
+      ("pq6: hugetlb", n, holds);
+  Run < pq6::PriorityQueue  < Key , PredicateType , LocalVector > >
+      ("pq6: huge, local", n, holds);
+  return EXIT_SUCCESS;
+}
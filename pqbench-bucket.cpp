@@ -0,0 +1,109 @@
+/*
+    pqbench-bucket.cpp
+
+    Timing of the bucket queue pq7 against pq5 and pq6 on an
+    fpq.com1-style command stream: a random mix of Push ('+'), Pop ('-')
+    and Front ('F') on Widgets whose priorities come from a small range of
+    integer levels.
+
+    usage: pqbench-bucket.x [ops] [size] [levels]
+       ops    number of commands to run         (default 10000000)
+       size   queue size the stream hovers at   (default 256)
+       levels number of distinct priorities     (default 256, at most 256)
+
+    Every implementation sees the same command stream, and pops the same
+    priorities in the same order, so the reported checksums must agree.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <chrono>
+
+#include <pair.h>      // to make pairs <fsu::String, int>
+#include <compare.h>   // generic lessthan and greaterthan predicates
+#include <xstring.h>   // fsu::String
+#include <xstring.cpp> // in lieu of makefile
+
+#include <pq.h>
+#include <pqbench.h>
+
+typedef fsu::Pair        < int, fsu::String > Widget;
+typedef fsu::LessThan    < Widget >           PredicateType;
+
+class WidgetLevel
+{
+public:
+  size_t operator () (const Widget& w) const
+  {
+    return static_cast<size_t>(w.first_);
+  }
+};
+
+const size_t names = 1000;
+fsu::String name[names];
+
+template < class Q >
+void Run (const char* implementation, Q& q, size_t ops, size_t size, size_t levels)
+{
+  pqb::Random r(4530);
+  Widget w;
+  unsigned long long checksum = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < ops; ++i)
+  {
+    unsigned long long c = r.Next(8);
+    if (c == 0)                                           // F
+    {
+      if (!q.Empty()) checksum += q.Front().first_;
+    }
+    else if (q.Empty() || c <= (q.Size() < size ? 5u : 3u)) // +
+    {
+      w.first_  = static_cast<int>(r.Next(levels));
+      w.second_ = name[r.Next(names)];
+      q.Push(w);
+    }
+    else                                                  // -
+    {
+      checksum = checksum * 31 + q.Front().first_;
+      q.Pop();
+    }
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  std::cout << std::setw(32) << std::left << implementation << std::right
+            << std::setw(10) << std::fixed << std::setprecision(3) << elapsed.count() << " s"
+            << std::setw(10) << std::setprecision(1) << 1e9 * elapsed.count() / ops << " ns/op"
+            << "   checksum " << checksum << '\n';
+}
+
+int main(int argc, char* argv[])
+{
+  size_t ops    = (argc > 1) ? std::strtoul(argv[1], 0, 10) : 10000000;
+  size_t size   = (argc > 2) ? std::strtoul(argv[2], 0, 10) : 256;
+  size_t levels = (argc > 3) ? std::strtoul(argv[3], 0, 10) : 256;
+  if (levels == 0 || levels > 256)
+  {
+    std::cout << "levels must be in [1,256] - try again\n";
+    return EXIT_FAILURE;
+  }
+
+  for (size_t i = 0; i < names; ++i)
+  {
+    char buf[4] = { char('a' + i / 676 % 26), char('a' + i / 26 % 26), char('a' + i % 26), '\0' };
+    name[i] = buf;
+  }
+
+  std::cout << ops << " commands, queue size ~" << size << ", "
+            << levels << " priority levels\n";
+
+  pq7::PriorityQueue < Widget , WidgetLevel , 256 > Q7;
+  Run("pq7: Deque[256], bitmap + clz", Q7, ops, size, levels);
+
+  pq6::PriorityQueue < Widget , PredicateType > Q6;
+  Run("pq6: Vector, hole sifts", Q6, ops, size, levels);
+
+  pq5::PriorityQueue < Widget , PredicateType > Q5;
+  Run("pq5: MOVector, Insert()", Q5, ops, size, levels);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,138 @@
+/*
+    pqbench-durable.cpp
+
+    What durability costs pqd::DurableQueue (pqdurable.h) per operation,
+    and what it saves at restart, against pq6 in memory:
+      fill     n pushes of random keys
+      hold     "holds" holds (pop the front f, push f - x)
+      restart  pq6: push the n keys again (the restart of a scheduler that
+               replays its events); pqd: reopen the file
+    pqd runs with sync None (survives the process) and sync Flush (survives
+    the machine: two msyncs per operation, so it runs n / 100 of each).
+
+    usage: pqbench-durable.x [n] [holds] [path]
+       n       queue size                             (default 1000000)
+       holds   hold operations                        (default 1000000)
+       path    queue file, removed at the end         (default pqbench-durable.dat)
+
+    The runs of the same size must report the same checksum.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <chrono>
+
+#include <compare.h>   // generic lessthan and greaterthan predicates
+#include <pq.h>
+#include <pqdurable.h>
+#include <pqbench.h>
+
+typedef unsigned long long            Key;
+typedef fsu::LessThan < Key >         PredicateType;
+
+typedef std::chrono::steady_clock Clock;
+
+double Seconds (Clock::time_point a, Clock::time_point b)
+{
+  return std::chrono::duration<double>(b - a).count();
+}
+
+void Report (const char* implementation, size_t n, double fill, size_t holds, double hold,
+             double restart, Key checksum)
+{
+  std::cout << std::left << std::setw(20) << implementation << std::right
+            << std::fixed << std::setprecision(1)
+            << std::setw(9) << n
+            << "  fill " << std::setw(8) << 1e9 * fill / n << " ns/op"
+            << "  hold " << std::setw(8) << (holds ? 1e9 * hold / holds : 0.0) << " ns/op"
+            << "  restart " << std::setprecision(3) << std::setw(9) << 1e3 * restart << " ms"
+            << "   checksum " << checksum << '\n';
+}
+
+template < class Q >
+Key Hold (Q& q, pqb::Random& r, size_t holds)
+{
+  Key checksum = 0;
+  for (size_t i = 0; i < holds; ++i)
+  {
+    Key f = q.Front();
+    checksum = checksum * 31 + f;
+    q.Pop();
+    q.Push(f - (r.Next() & 0xFFFFFF));
+  }
+  return checksum;
+}
+
+void Memory (size_t n, size_t holds)
+{
+  typedef pq6::PriorityQueue < Key , PredicateType > Q;
+  pqb::Random r(4530);
+  Q q;
+  Clock::time_point t0 = Clock::now();
+  for (size_t i = 0; i < n; ++i)
+    q.Push(r.Next());
+  Clock::time_point t1 = Clock::now();
+  Key checksum = Hold(q, r, holds);
+  Clock::time_point t2 = Clock::now();
+
+  // a restart without a file: every key pushed again
+  pqb::Random again(4530);
+  Q p;
+  for (size_t i = 0; i < n; ++i)
+    p.Push(again.Next());
+  Clock::time_point t3 = Clock::now();
+  checksum += p.Size();
+  Report("pq6: memory", n, Seconds(t0, t1), holds, Seconds(t1, t2), Seconds(t2, t3), checksum);
+}
+
+void Durable (const char* implementation, pqd::Sync sync, size_t n, size_t holds, const char* path)
+{
+  typedef pqd::DurableQueue < Key , PredicateType > Q;
+  Q::Remove(path);
+  pqb::Random r(4530);
+  Key checksum;
+  Clock::time_point t0, t1, t2, t3;
+  {
+    Q q;
+    if (!q.Open(path, sync))
+    {
+      std::cout << "cannot open " << path << '\n';
+      return;
+    }
+    t0 = Clock::now();
+    for (size_t i = 0; i < n; ++i)
+      q.Push(r.Next());
+    t1 = Clock::now();
+    checksum = Hold(q, r, holds);
+    t2 = Clock::now();
+  }
+  {
+    // the restart: map the file again
+    Clock::time_point t = Clock::now();
+    Q q;
+    q.Open(path, sync);
+    t3 = Clock::now();
+    t3 = t2 + (t3 - t);
+    checksum += q.Size();
+  }
+  Q::Remove(path);
+  Report(implementation, n, Seconds(t0, t1), holds, Seconds(t1, t2), Seconds(t2, t3), checksum);
+}
+
+int main(int argc, char* argv[])
+{
+  size_t      n     = (argc > 1) ? std::strtoul(argv[1], 0, 10) : 1000000;
+  size_t      holds = (argc > 2) ? std::strtoul(argv[2], 0, 10) : 1000000;
+  const char* path  = (argc > 3) ? argv[3] : "pqbench-durable.dat";
+  if (n == 0)
+  {
+    std::cout << "n must be positive - try again\n";
+    return EXIT_FAILURE;
+  }
+  Memory(n, holds);
+  Durable("pqd: sync None", pqd::None, n, holds, path);
+  Memory(n / 100 + 1, holds / 100);
+  Durable("pqd: sync Flush", pqd::Flush, n / 100 + 1, holds / 100, path);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,81 @@
+/*
+    pqbench-hold.cpp
+
+    Hold-model timing of the calendar queue pq8 against pq6, the classic
+    event-list benchmark: fill the queue with n events, then repeatedly
+    pop the earliest event at time t and push a new one at t + x, where
+    x is drawn from an exponential distribution with mean 1.
+
+    usage: pqbench-hold.x [holds] [min size] [max size]
+       holds     hold operations per queue size  (default 1000000)
+       min size  smallest queue size             (default 1000)
+       max size  largest queue size              (default 10000000)
+
+    Queue sizes run through min size, 10 * min size, ... up to max size.
+    Both queues see the same events and must report the same checksum.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+
+#include <compare.h>   // generic lessthan and greaterthan predicates
+#include <pq.h>
+#include <pqbench.h>
+
+class EventTime
+{
+public:
+  double operator () (double t) const
+  {
+    return t;
+  }
+};
+
+template < class Q >
+void Run (const char* implementation, size_t size, size_t holds)
+{
+  Q q;
+  pqb::Random r(4530);
+  for (size_t i = 0; i < size; ++i)
+    q.Push(r.Exponential());
+
+  double checksum = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < holds; ++i)
+  {
+    double t = q.Front();
+    q.Pop();
+    checksum += t;
+    q.Push(t + r.Exponential());
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  std::cout << std::setw(10) << size << "  "
+            << std::setw(28) << std::left << implementation << std::right
+            << std::setw(10) << std::fixed << std::setprecision(1) << 1e9 * elapsed.count() / holds << " ns/hold"
+            << "   checksum " << std::setprecision(6) << checksum << '\n';
+}
+
+int main(int argc, char* argv[])
+{
+  size_t holds   = (argc > 1) ? std::strtoul(argv[1], 0, 10) : 1000000;
+  size_t minSize = (argc > 2) ? std::strtoul(argv[2], 0, 10) : 1000;
+  size_t maxSize = (argc > 3) ? std::strtoul(argv[3], 0, 10) : 10000000;
+  if (minSize == 0)
+  {
+    std::cout << "min size must be positive - try again\n";
+    return EXIT_FAILURE;
+  }
+
+  std::cout << holds << " holds per size, exponential increments\n";
+  for (size_t size = minSize; size <= maxSize; size *= 10)
+  {
+    Run < pq8::PriorityQueue < double , EventTime > >
+      ("pq8: calendar queue", size, holds);
+    Run < pq6::PriorityQueue < double , fsu::GreaterThan < double > > >
+      ("pq6: Vector, hole sifts", size, holds);
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,121 @@
+/*
+    pqbench-inttrie.cpp
+
+    pq18 (bit trie over 32-bit keys) against the comparison heaps pq6 and
+    pq10 on unsigned 32-bit keys, and the cost of the operations only
+    pq18 offers: Successor() and Erase() of an arbitrary key.
+
+    workload   operations (n = size)
+    --------   ----------
+    dense      n pushes of random keys in [0,4n), like ids, then drain
+    hold       n pushes as in dense, n holds (pop the front f, push f - x
+               for a random x < 65536, a deadline-like key), then drain
+    sparse     n pushes of random keys in [0,2^32), then drain: the worst
+               case for pq18, which allocates a block for almost every key
+    search     pq18 only: n Successor() and n Erase() of random keys in
+               [0,4n) in a queue filled as in dense
+
+    usage: pqbench-inttrie.x [n]
+       n   size                                        (default 1000000)
+
+    All queues must report the same checksum for each workload.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <chrono>
+
+#include <compare.h>   // generic lessthan and greaterthan predicates
+#include <pq.h>
+#include <pqbench.h>
+
+typedef unsigned int                  Key;
+typedef fsu::LessThan < Key >         PredicateType;
+
+void Report (const char* implementation, const char* workload, double seconds,
+             size_t ops, unsigned long long checksum)
+{
+  std::cout << std::left << std::setw(22) << implementation
+            << std::setw(8) << workload << std::right
+            << std::fixed << std::setprecision(1)
+            << std::setw(10) << 1e9 * seconds / ops << " ns/op"
+            << "   checksum " << checksum << '\n';
+}
+
+Key Draw (pqb::Random& r, size_t n, const char* workload)
+{
+  return workload[0] == 's' ? static_cast<Key>(r.Bits(32)) : static_cast<Key>(r.Bits(32) % (4 * n));
+}
+
+template < class Q >
+void Run (const char* implementation, const char* workload, size_t n)
+{
+  pqb::Random r(4530);
+  Q q;
+  unsigned long long checksum = 0;
+  size_t ops = n;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < n; ++i)
+    q.Push(Draw(r, n, workload));
+  if (workload[0] == 'h')
+  {
+    for (size_t i = 0; i < n; ++i)
+    {
+      Key f = q.Front();
+      checksum = checksum * 31 + f;
+      q.Pop();
+      Key x = static_cast<Key>(r.Bits(16));
+      q.Push(f > x ? f - x : 0);
+    }
+    ops += 2 * n;
+  }
+  while (!q.Empty())
+  {
+    checksum = checksum * 31 + q.Front();
+    q.Pop();
+  }
+  ops += n;
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  Report(implementation, workload, elapsed.count(), ops, checksum);
+}
+
+void Search (size_t n)
+{
+  typedef pq18::PriorityQueue < Key , PredicateType > Q;
+  pqb::Random r(4530);
+  Q q;
+  for (size_t i = 0; i < n; ++i)
+    q.Push(Draw(r, n, "dense"));
+  unsigned long long checksum = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < n; ++i)
+  {
+    Key s;
+    if (q.Successor(Draw(r, n, "dense"), s))
+      checksum = checksum * 31 + s;
+  }
+  for (size_t i = 0; i < n; ++i)
+    checksum += q.Erase(Draw(r, n, "dense"));
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  Report("pq18: bit trie", "search", elapsed.count(), 2 * n, checksum);
+}
+
+int main(int argc, char* argv[])
+{
+  size_t n = (argc > 1) ? std::strtoul(argv[1], 0, 10) : 1000000;
+  if (n == 0)
+  {
+    std::cout << "n must be positive - try again\n";
+    return EXIT_FAILURE;
+  }
+  const char* workloads[] = { "dense", "hold", "sparse" };
+  for (size_t w = 0; w < 3; ++w)
+  {
+    Run < pq6::PriorityQueue  < Key , PredicateType > >      ("pq6: binary heap", workloads[w], n);
+    Run < pq10::PriorityQueue < Key , PredicateType , 4 > >  ("pq10: 4-ary heap", workloads[w], n);
+    Run < pq18::PriorityQueue < Key , PredicateType > >      ("pq18: bit trie", workloads[w], n);
+  }
+  Search(n);
+  return EXIT_SUCCESS;
+}
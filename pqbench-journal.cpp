@@ -0,0 +1,201 @@
+/*
+    pqbench-journal.cpp
+
+    pqj::JournalQueue (pqjournal.h) over pq6: what group commit buys, and
+    how recovery time grows with the log.
+
+    commit    n pushes, then "ops" holds (pop the front f, push f - x) on
+              pq6 in memory and journaled with batches of 1 (ops / 1000
+              holds only), 64, 1024, 16384 and 262144 records per
+              fdatasync; reported in durable operations per second (the
+              last batch committed) and ns per operation; then pq11,
+              whose predicate orders keys drawn from the records, with
+              batches of 16384 and a recovery of the log it leaves
+    recovery  logs of 10^4 .. 10^7 records of the same workload (a fill
+              of a tenth, then holds), closed, then reopened: the time of
+              Open, which reads the log, cancels pops against pushes,
+              sorts and bulk loads; then again after Checkpoint()
+
+    usage: pqbench-journal.x [n] [ops] [path]
+       n      queue size for the commit runs               (default 100000)
+       ops    hold operations for the commit runs          (default 2000000)
+       path   log file, removed at the end                 (default pqbench-journal.log)
+
+    The commit runs must report the same checksum.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <chrono>
+
+#include <compare.h>   // generic lessthan and greaterthan predicates
+#include <pq.h>
+#include <pqjournal.h>
+#include <pqbench.h>
+
+typedef unsigned long long                         Key;
+typedef fsu::LessThan < Key >                      PredicateType;
+typedef pq6::PriorityQueue < Key , PredicateType > MemoryQueue;
+typedef pqj::JournalQueue < MemoryQueue >          JournalQueue;
+
+// a record with a payload, for pq11: its key is the priority alone
+struct Record
+{
+  Record() {}
+  Record(Key k) : priority_(k), payload_(~k) {}
+  operator Key () const { return priority_; }
+  bool operator == (const Record& r) const
+  {
+    return priority_ == r.priority_ && payload_ == r.payload_;
+  }
+  Key priority_;
+  Key payload_;
+};
+
+struct PriorityOf
+{
+  Key operator () (const Record& r) const { return r.priority_; }
+};
+
+typedef pq11::PriorityQueue < Record , PriorityOf , PredicateType > KeySlotQueue;
+typedef pqj::JournalQueue < KeySlotQueue >                          KeySlotJournal;
+
+typedef std::chrono::steady_clock Clock;
+
+double Seconds (Clock::time_point a, Clock::time_point b)
+{
+  return std::chrono::duration<double>(b - a).count();
+}
+
+template < class Q >
+Key Hold (Q& q, pqb::Random& r, size_t n, size_t ops)
+{
+  for (size_t i = 0; i < n; ++i)
+    q.Push(r.Next());
+  Key checksum = 0;
+  for (size_t i = 0; i < ops; ++i)
+  {
+    Key f = q.Front();
+    checksum = checksum * 31 + f;
+    q.Pop();
+    q.Push(f - (r.Next() & 0xFFFFFF));
+  }
+  return checksum;
+}
+
+void Report (const char* implementation, size_t batch, size_t ops, double seconds,
+             unsigned long long commits, Key checksum)
+{
+  std::cout << std::left << std::setw(14) << implementation << std::right;
+  if (batch) std::cout << std::setw(8) << batch;
+  else       std::cout << std::setw(8) << "-";
+  std::cout << std::fixed << std::setprecision(0)
+            << std::setw(12) << ops / seconds << " ops/s"
+            << std::setprecision(1) << std::setw(10) << 1e9 * seconds / ops << " ns/op"
+            << std::setw(10) << commits << " commits"
+            << "   checksum " << checksum << '\n';
+}
+
+void Commit (size_t n, size_t ops, const char* path)
+{
+  std::cout << "commit: n " << n << ", " << ops << " holds (2 records each)\n"
+            << "queue            batch     durable             per op\n";
+  {
+    pqb::Random r(4530);
+    MemoryQueue q;
+    Clock::time_point start = Clock::now();
+    Key checksum = Hold(q, r, n, ops);
+    Report("pq6: memory", 0, n + 2 * ops, Seconds(start, Clock::now()), 0, checksum);
+  }
+  const size_t batches[] = { 1, 64, 1024, 16384, 262144 };
+  for (size_t b = 0; b < sizeof(batches) / sizeof(batches[0]); ++b)
+  {
+    size_t m = batches[b] == 1 ? n / 1000 + 1 : n;
+    size_t h = batches[b] == 1 ? ops / 1000 + 1 : ops;
+    JournalQueue::Remove(path);
+    pqb::Random r(4530);
+    JournalQueue q;
+    if (!q.Open(path, batches[b]))
+    {
+      std::cout << "cannot open " << path << '\n';
+      return;
+    }
+    Clock::time_point start = Clock::now();
+    Key checksum = Hold(q, r, m, h);
+    q.Commit();
+    Report("journaled", batches[b], m + 2 * h, Seconds(start, Clock::now()), q.Commits(),
+           batches[b] == 1 ? 0 : checksum);
+  }
+  {
+    KeySlotJournal::Remove(path);
+    pqb::Random r(4530);
+    KeySlotJournal q;
+    if (!q.Open(path, 16384))
+    {
+      std::cout << "cannot open " << path << '\n';
+      return;
+    }
+    Clock::time_point start = Clock::now();
+    Key checksum = Hold(q, r, n, ops);
+    q.Commit();
+    Report("pq11: journal", 16384, n + 2 * ops, Seconds(start, Clock::now()), q.Commits(), checksum);
+    size_t size = q.Size();
+    q.Close();
+    KeySlotJournal c;
+    c.Open(path);
+    if (c.Size() != size || (size > 0 && c.Front().payload_ != ~c.Front().priority_))
+      std::cout << "pq11: recovered " << c.Size() << " of " << size << '\n';
+  }
+  JournalQueue::Remove(path);
+}
+
+void Recovery (const char* path)
+{
+  std::cout << "\nrecovery:\n"
+            << "   records    log MB      size   recover ms   after Checkpoint ms\n";
+  for (size_t records = 10000; records <= 10000000; records *= 10)
+  {
+    JournalQueue::Remove(path);
+    size_t size;
+    {
+      pqb::Random r(4530);
+      JournalQueue q;
+      q.Open(path, 65536);
+      Hold(q, r, records / 10, (records - records / 10) / 2);
+      size = q.Size();
+    }
+    Clock::time_point t0 = Clock::now();
+    JournalQueue q;
+    q.Open(path);
+    Clock::time_point t1 = Clock::now();
+    double mb = q.LogBytes() / 1e6;
+    if (q.Size() != size) std::cout << "recovered " << q.Size() << " of " << size << '\n';
+    q.Checkpoint();
+    q.Close();
+    Clock::time_point t2 = Clock::now();
+    JournalQueue c;
+    c.Open(path);
+    Clock::time_point t3 = Clock::now();
+    std::cout << std::fixed << std::setprecision(1)
+              << std::setw(10) << records << std::setw(10) << mb << std::setw(10) << size
+              << std::setw(13) << 1e3 * Seconds(t0, t1)
+              << std::setw(22) << 1e3 * Seconds(t2, t3) << '\n';
+  }
+  JournalQueue::Remove(path);
+}
+
+int main(int argc, char* argv[])
+{
+  size_t      n    = (argc > 1) ? std::strtoul(argv[1], 0, 10) : 100000;
+  size_t      ops  = (argc > 2) ? std::strtoul(argv[2], 0, 10) : 2000000;
+  const char* path = (argc > 3) ? argv[3] : "pqbench-journal.log";
+  if (n == 0)
+  {
+    std::cout << "n must be positive - try again\n";
+    return EXIT_FAILURE;
+  }
+  Commit(n, ops, path);
+  Recovery(path);
+  return EXIT_SUCCESS;
+}
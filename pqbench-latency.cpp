@@ -0,0 +1,104 @@
+/*
+    pqbench-latency.cpp
+
+    Per-operation latency of pq5 and pq6 with pql::LatencyQueue: the queue
+    grows from empty to n elements (push), runs n holds (pop the largest,
+    push a random key), and is drained (pop). The mean cost of each run is
+    measured with and without the wrapper; the difference is the recording
+    overhead per operation, most of which is the two clock reads (the cost
+    of one is printed first: a few ns for a native time stamp counter, much
+    more where a virtual machine traps it).
+
+    usage: pqbench-latency.x [n] [dump]
+       n     largest queue size; pq5 at most 100000   (default 1000000)
+       dump  print the full Push histogram of each queue
+
+    Both runs of a queue must report the same checksum.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+
+#include <compare.h>   // generic lessthan and greaterthan predicates
+#include <pq.h>
+#include <pqlatency.h>
+#include <pqbench.h>
+
+typedef unsigned long long            Key;
+typedef fsu::LessThan < Key >         PredicateType;
+
+template < class Q >
+double Run (Q& q, size_t n, Key& checksum)
+// ns per operation
+{
+  pqb::Random r(4530);
+  checksum = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < n; ++i)
+    q.Push(r.Next());
+  for (size_t i = 0; i < n; ++i)
+  {
+    checksum += q.Front();
+    q.Pop();
+    q.Push(r.Next());
+  }
+  while (!q.Empty())
+  {
+    checksum = checksum * 31 + q.Front();
+    q.Pop();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return 1e9 * elapsed.count() / (6 * n);   // push, hold = front pop push, front pop
+}
+
+template < class Q >
+void Compare (const char* implementation, size_t n, bool dump)
+{
+  Key plain, timed;
+  Q q;
+  double base = Run(q, n, plain);
+  pql::LatencyQueue < Q > t;
+  double cost = Run(t, n, timed);
+
+  std::cout << implementation << "   checksum " << plain
+            << (plain == timed ? "" : "  ** timed run differs **") << '\n'
+            << std::fixed << std::setprecision(1)
+            << "  plain " << base << " ns/op, timed " << cost
+            << " ns/op, overhead " << cost - base << " ns/op\n";
+  t.Report(std::cout);
+  if (dump)
+  {
+    std::cout << "  Push histogram:\n";
+    t.PushLatency().Dump(std::cout, pql::DefaultClock::NsPerTick());
+  }
+  std::cout << '\n';
+}
+
+int main(int argc, char* argv[])
+{
+  size_t n  = (argc > 1) ? std::strtoul(argv[1], 0, 10) : 1000000;
+  bool dump = (argc > 2) && std::strcmp(argv[2], "dump") == 0;
+  if (n == 0)
+  {
+    std::cout << "n must be positive - try again\n";
+    return EXIT_FAILURE;
+  }
+
+  pql::DefaultClock::NsPerTick();   // calibrate before timing
+  // two clock reads per operation are most of the overhead
+  pql::Tick t = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < 1000000; ++i)
+    t += pql::DefaultClock::Now();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  std::cout << "clock read " << std::fixed << std::setprecision(1) << 1e3 * elapsed.count()
+            << " ns" << (t == 1 ? " " : "") << "\n\n";
+  Compare < pq6::PriorityQueue < Key , PredicateType > > ("pq6: Vector, hole sifts", n, dump);
+  // pq5 pushes are O(n): at most 100000 elements
+  Compare < pq5::PriorityQueue < Key , PredicateType > > ("pq5: MOVector, Insert()",
+                                                          n < 100000 ? n : 100000, dump);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,85 @@
+/*
+    pqbench-merge.cpp
+
+    Throughput of k-way merging with the loser tree km::KWayMerge against
+    km::PQMerge, which keeps the k heads in a pq6 heap, for k = 2 .. 1024.
+    For each k, n random 8-byte keys are cut into k runs of (almost) equal
+    length, each run is sorted, and the runs are merged into one array.
+
+    usage: pqbench-merge.x [n]
+       n  total number of keys  (default 16777216 = 2^24)
+
+    Both merges must report the same checksum, and "sorted" must be yes.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <chrono>
+
+#include <compare.h>   // generic lessthan and greaterthan predicates
+#include <gheap.h>     // fsu::g_heap_sort()
+#include <vector.h>
+#include <kmerge.h>
+#include <pqbench.h>
+
+typedef unsigned long long            Key;
+typedef fsu::LessThan < Key >         PredicateType;
+
+template < class Merger >
+void Run (const char* implementation, const fsu::Vector < Key > & in, size_t k)
+{
+  size_t n = in.Size();
+  fsu::Vector < Key > out;
+  out.SetSize(n);
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  Merger m;
+  for (size_t r = 0; r < k; ++r)
+    m.AddRange(&in[0] + r * n / k, &in[0] + (r + 1) * n / k);
+  m.Merge(&out[0]);
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  bool sorted = true;
+  Key checksum = 0;
+  for (size_t i = 0; i < n; ++i)
+  {
+    if (i > 0 && out[i] < out[i - 1]) sorted = false;
+    checksum = checksum * 31 + out[i];
+  }
+  std::cout << std::setw(6) << k << "  "
+            << std::setw(22) << std::left << implementation << std::right
+            << std::fixed << std::setprecision(2)
+            << std::setw(8) << 1e9 * elapsed.count() / n << " ns/elem"
+            << std::setw(9) << n / elapsed.count() / 1e6 << " M elem/s"
+            << "   sorted " << (sorted ? "yes" : "no")
+            << "   checksum " << checksum << '\n';
+}
+
+int main(int argc, char* argv[])
+{
+  size_t n = (argc > 1) ? std::strtoul(argv[1], 0, 10) : (size_t(1) << 24);
+  if (n < 1024)
+  {
+    std::cout << "n must be at least 1024 - try again\n";
+    return EXIT_FAILURE;
+  }
+
+  PredicateType p;
+  fsu::Vector < Key > in;
+  in.SetSize(n);
+  for (size_t k = 2; k <= 1024; k *= 2)
+  {
+    pqb::Random r(4530);
+    for (size_t i = 0; i < n; ++i)
+      in[i] = r.Next();
+    for (size_t j = 0; j < k; ++j)
+      fsu::g_heap_sort(&in[0] + j * n / k, &in[0] + (j + 1) * n / k, p);
+
+    Run < km::KWayMerge < const Key* , PredicateType > >
+      ("loser tree", in, k);
+    Run < km::PQMerge < const Key* , PredicateType , pq6::PriorityQueue > >
+      ("pq6 heap of heads", in, k);
+  }
+  return EXIT_SUCCESS;
+}
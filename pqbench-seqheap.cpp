@@ -0,0 +1,88 @@
+/*
+    pqbench-seqheap.cpp
+
+    Timing of the sequence heap pq9 against the binary heap pq6 and the
+    4-ary heap pq10 as the queue outgrows each level of the memory
+    hierarchy. Elements are 8-byte keys, so the default sizes correspond
+    to about 32 KiB (L1), 1 MiB (L2), 16 MiB (L3), 256 MiB and 1 GiB (DRAM).
+
+    For each size n the queue is filled with n random keys (push), then
+    runs n/2 holds (pop the largest, push a random key), then is drained
+    (pop).
+
+    usage: pqbench-seqheap.x [max size]
+       max size  largest n to run  (default 134217728 = 2^27)
+
+    All three queues must report the same checksum for each size.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <chrono>
+
+#include <compare.h>   // generic lessthan and greaterthan predicates
+#include <pq.h>
+#include <pqbench.h>
+
+typedef unsigned long long            Key;
+typedef fsu::LessThan < Key >         PredicateType;
+
+double Since (std::chrono::steady_clock::time_point start)
+{
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+template < class Q >
+void Run (const char* implementation, size_t n)
+{
+  Q q;
+  pqb::Random r(4530);
+  Key checksum = 0;
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < n; ++i)
+    q.Push(r.Next());
+  double push = Since(start);
+
+  start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < n / 2; ++i)
+  {
+    checksum += q.Front();
+    q.Pop();
+    q.Push(r.Next());
+  }
+  double hold = Since(start);
+
+  start = std::chrono::steady_clock::now();
+  while (!q.Empty())
+  {
+    checksum = checksum * 31 + q.Front();
+    q.Pop();
+  }
+  double pop = Since(start);
+
+  std::cout << std::setw(11) << n << "  "
+            << std::setw(24) << std::left << implementation << std::right
+            << std::fixed << std::setprecision(1)
+            << std::setw(8) << 1e9 * push / n << " push"
+            << std::setw(8) << 1e9 * hold / (n / 2 > 0 ? n / 2 : 1) << " hold"
+            << std::setw(8) << 1e9 * pop / n << " pop  (ns)"
+            << "   checksum " << checksum << '\n';
+}
+
+int main(int argc, char* argv[])
+{
+  size_t maxSize = (argc > 1) ? std::strtoul(argv[1], 0, 10) : (size_t(1) << 27);
+
+  const size_t size[] = { size_t(1) << 12, size_t(1) << 17, size_t(1) << 21,
+                          size_t(1) << 25, size_t(1) << 27 };
+  for (size_t i = 0; i < sizeof(size) / sizeof(size[0]) && size[i] <= maxSize; ++i)
+  {
+    Run < pq9::PriorityQueue  < Key , PredicateType > >    ("pq9: sequence heap", size[i]);
+    Run < pq6::PriorityQueue  < Key , PredicateType > >    ("pq6: Vector, hole sifts", size[i]);
+    Run < pq10::PriorityQueue < Key , PredicateType , 4 > > ("pq10: 4-ary heap", size[i]);
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,357 @@
+/*
+    pqbench-shm.cpp
+
+    Several processes on one machine share one priority queue, two ways:
+
+    shm      pqs::SharedQueue (pqshm.h): producers and consumers open the
+             same shared-memory segment and push and pop it directly
+    broker   one broker process owns a pq6 heap; producers send it items
+             over Unix sockets, and consumers send it a request and wait
+             for the item in reply, as in a socket-forwarding broker
+
+    Every producer sends "items" items with random priorities, paced at
+    "rate" items per second (0: as fast as it can), each stamped with the
+    time it was sent; consumers record the time from send to receipt in a
+    latency histogram (pqlatency.h). Reported per mode: the throughput over
+    the whole run and the latency mean, p50, p99, p99.9 and max.
+
+    usage: pqbench-shm.x [producers] [consumers] [items] [rate]
+       producers  producer processes                     (default 2)
+       consumers  consumer processes                     (default 2)
+       items      items per producer                     (default 100000)
+       rate       items per second per producer, 0 = flat out
+                                                         (default 20000)
+
+    Both modes must report the same checksum (the sum of all keys received).
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include <time.h>          // clock_nanosleep()
+#include <poll.h>          // poll()
+#include <signal.h>        // signal()
+#include <sys/mman.h>      // mmap()
+#include <sys/socket.h>    // socketpair()
+#include <sys/wait.h>      // waitpid()
+#include <unistd.h>        // fork(), _exit()
+
+#include <compare.h>   // generic lessthan and greaterthan predicates
+#include <pq.h>
+#include <pqshm.h>
+#include <pqlatency.h>
+#include <pqbench.h>
+
+typedef unsigned long long Key;
+
+struct Item
+{
+  Key       key_;
+  long long sent_;       // ns, steady clock; -1: no more items
+};
+
+struct ItemLess
+{
+  bool operator () (const Item& a, const Item& b) const
+  {
+    return a.key_ < b.key_;
+  }
+};
+
+typedef pql::Histogram < >               Histogram;
+typedef pqs::SharedQueue < Item , ItemLess > SharedQueue;
+
+const char* const Segment = "/pqbench-shm";
+
+// steady_clock is CLOCK_MONOTONIC, the same in every process
+long long Now ()
+{
+  return pql::SteadyClock::Now();
+}
+
+// sleep until the i-th send of a producer paced at rate per second
+void Pace (long long start, size_t i, size_t rate)
+{
+  if (rate == 0) return;
+  long long t = start + static_cast<long long>(1e9 * i / rate);
+  struct timespec ts;
+  ts.tv_sec  = t / 1000000000;
+  ts.tv_nsec = t % 1000000000;
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, 0) != 0)
+  {}
+}
+
+// per-consumer results, in memory shared with the parent
+struct Result
+{
+  Histogram          latency_;
+  unsigned long long checksum_;
+};
+
+void Receive (Result& r, const Item& item)
+{
+  long long d = Now() - item.sent_;
+  r.latency_.Record(d > 0 ? static_cast<pql::Tick>(d) : 0);
+  r.checksum_ += item.key_;
+}
+
+void Wait (std::vector < pid_t > & pids)
+{
+  for (size_t i = 0; i < pids.size(); ++i)
+  {
+    int status;
+    waitpid(pids[i], &status, 0);
+  }
+  pids.clear();
+}
+
+void Report (const char* mode, Result* results, size_t consumers, double seconds)
+{
+  Result total;
+  total.latency_.Clear();
+  total.checksum_ = 0;
+  for (size_t c = 0; c < consumers; ++c)
+  {
+    total.latency_.Merge(results[c].latency_);
+    total.checksum_ += results[c].checksum_;
+  }
+  std::cout << std::left << std::setw(8) << mode << std::right << std::fixed << std::setprecision(0)
+            << std::setw(10) << total.latency_.Count() / seconds << " items/s   checksum "
+            << total.checksum_ << "\n        latency ";
+  total.latency_.Summary(std::cout);
+}
+
+// ---- shm: every process opens the segment -------------------------------
+
+void ShmProducer (size_t id, size_t items, size_t rate, long long start)
+{
+  SharedQueue q;
+  if (!q.Open(Segment)) _exit(EXIT_FAILURE);
+  pqb::Random r(4530 + id);
+  for (size_t i = 0; i < items; ++i)
+  {
+    Pace(start, i, rate);
+    Item item = { r.Next(), Now() };
+    q.Push(item);
+  }
+  _exit(EXIT_SUCCESS);
+}
+
+void ShmConsumer (Result& result)
+{
+  SharedQueue q;
+  if (!q.Open(Segment)) _exit(EXIT_FAILURE);
+  Item item;
+  while (q.Pop(item))
+    Receive(result, item);
+  _exit(EXIT_SUCCESS);
+}
+
+double Shm (size_t producers, size_t consumers, size_t items, size_t rate, Result* results)
+{
+  SharedQueue::Unlink(Segment);               // left over from a killed run
+  SharedQueue q;
+  if (!q.Create(Segment, producers * items))
+  {
+    std::cout << "shm: cannot create " << Segment << '\n';
+    return 0.0;
+  }
+  std::vector < pid_t > ps, cs;
+  long long start = Now();
+  for (size_t c = 0; c < consumers; ++c)
+  {
+    pid_t pid = fork();
+    if (pid == 0) ShmConsumer(results[c]);
+    cs.push_back(pid);
+  }
+  for (size_t p = 0; p < producers; ++p)
+  {
+    pid_t pid = fork();
+    if (pid == 0) ShmProducer(p, items, rate, start);
+    ps.push_back(pid);
+  }
+  Wait(ps);
+  q.Shutdown();
+  Wait(cs);
+  double seconds = (Now() - start) * 1e-9;
+  SharedQueue::Unlink(Segment);
+  return seconds;
+}
+
+// ---- broker: one process owns a pq6 and forwards over sockets -----------
+
+void BrokerProducer (int fd, size_t id, size_t items, size_t rate, long long start)
+{
+  pqb::Random r(4530 + id);
+  for (size_t i = 0; i < items; ++i)
+  {
+    Pace(start, i, rate);
+    Item item = { r.Next(), Now() };
+    if (write(fd, &item, sizeof(item)) != sizeof(item)) _exit(EXIT_FAILURE);
+  }
+  _exit(EXIT_SUCCESS);
+}
+
+void BrokerConsumer (int fd, Result& result)
+{
+  char request = '?';
+  Item item;
+  while (write(fd, &request, 1) == 1 && read(fd, &item, sizeof(item)) == sizeof(item)
+         && item.sent_ >= 0)
+    Receive(result, item);
+  _exit(EXIT_SUCCESS);
+}
+
+void Broker (const std::vector < int > & producers, const std::vector < int > & consumers)
+{
+  pq6::PriorityQueue < Item , ItemLess > q;
+  size_t np = producers.size(), nc = consumers.size();
+  std::vector < struct pollfd > fds(np + nc);
+  for (size_t i = 0; i < np + nc; ++i)
+  {
+    fds[i].fd = i < np ? producers[i] : consumers[i - np];
+    fds[i].events = POLLIN;
+  }
+  std::vector < bool > waiting(nc, false);
+  size_t open = np, done = 0;
+  while (done < nc)
+  {
+    poll(&fds[0], fds.size(), -1);
+    for (size_t i = 0; i < np; ++i)
+    {
+      if (fds[i].fd < 0 || fds[i].revents == 0) continue;
+      Item item;
+      if (read(fds[i].fd, &item, sizeof(item)) == sizeof(item))
+        q.Push(item);
+      else
+      {
+        fds[i].fd = -1;                        // producer finished
+        --open;
+      }
+    }
+    for (size_t c = 0; c < nc; ++c)
+    {
+      struct pollfd& f = fds[np + c];
+      char request;
+      if (f.fd < 0 || f.revents == 0) continue;
+      if (read(f.fd, &request, 1) == 1)
+        waiting[c] = true;
+      else
+      {
+        f.fd = -1;                             // consumer gone
+        ++done;
+      }
+    }
+    for (size_t c = 0; c < nc; ++c)
+    {
+      if (!waiting[c]) continue;
+      Item item = { 0, -1 };
+      if (!q.Empty())
+      {
+        item = q.Front();
+        q.Pop();
+      }
+      else if (open > 0)
+        continue;
+      if (write(consumers[c], &item, sizeof(item)) != sizeof(item) || item.sent_ < 0)
+      {
+        fds[np + c].fd = -1;
+        ++done;
+      }
+      waiting[c] = false;
+    }
+  }
+  _exit(EXIT_SUCCESS);
+}
+
+double Brokered (size_t producers, size_t consumers, size_t items, size_t rate, Result* results)
+{
+  std::vector < int > pfd, cfd;
+  std::vector < pid_t > ps, cs, bs;
+  long long start = Now();
+  for (size_t c = 0; c < consumers; ++c)
+  {
+    int sv[2];
+    socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sv);
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+      close(sv[0]);
+      BrokerConsumer(sv[1], results[c]);
+    }
+    cs.push_back(pid);
+    close(sv[1]);
+    cfd.push_back(sv[0]);
+  }
+  for (size_t p = 0; p < producers; ++p)
+  {
+    int sv[2];
+    socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sv);
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+      for (size_t i = 0; i < pfd.size(); ++i) close(pfd[i]);
+      close(sv[0]);
+      BrokerProducer(sv[1], p, items, rate, start);
+    }
+    ps.push_back(pid);
+    close(sv[1]);
+    pfd.push_back(sv[0]);
+  }
+  pid_t broker = fork();
+  if (broker == 0) Broker(pfd, cfd);
+  bs.push_back(broker);
+  for (size_t i = 0; i < pfd.size(); ++i) close(pfd[i]);
+  for (size_t i = 0; i < cfd.size(); ++i) close(cfd[i]);
+  Wait(ps);
+  Wait(cs);
+  Wait(bs);
+  return (Now() - start) * 1e-9;
+}
+
+int main(int argc, char* argv[])
+{
+  size_t producers = (argc > 1) ? std::strtoul(argv[1], 0, 10) : 2;
+  size_t consumers = (argc > 2) ? std::strtoul(argv[2], 0, 10) : 2;
+  size_t items     = (argc > 3) ? std::strtoul(argv[3], 0, 10) : 100000;
+  size_t rate      = (argc > 4) ? std::strtoul(argv[4], 0, 10) : 20000;
+  if (producers == 0 || consumers == 0 || items == 0)
+  {
+    std::cout << "producers, consumers and items must be positive - try again\n";
+    return EXIT_FAILURE;
+  }
+  signal(SIGPIPE, SIG_IGN);
+  std::cout << producers << " producers, " << consumers << " consumers, " << items
+            << " items each, ";
+  if (rate) std::cout << rate << " items/s per producer\n";
+  else      std::cout << "flat out\n";
+
+  // one Result per consumer, shared with the children
+  void* m = mmap(0, consumers * sizeof(Result), PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (m == MAP_FAILED)
+  {
+    std::cout << "mmap failed\n";
+    return EXIT_FAILURE;
+  }
+  Result* results = static_cast<Result*>(m);
+
+  const char* modes[] = { "shm", "broker" };
+  for (size_t mode = 0; mode < 2; ++mode)
+  {
+    for (size_t c = 0; c < consumers; ++c)
+    {
+      new (&results[c].latency_) Histogram;
+      results[c].checksum_ = 0;
+    }
+    std::cout << std::flush;
+    double seconds = mode == 0 ? Shm(producers, consumers, items, rate, results)
+                               : Brokered(producers, consumers, items, rate, results);
+    if (seconds > 0) Report(modes[mode], results, consumers, seconds);
+  }
+  munmap(m, consumers * sizeof(Result));
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,90 @@
+/*
+    pqbench-snapshot.cpp
+
+    Snapshot-heavy workload: pq15 (persistent leftist heap, O(1) copy)
+    against pq6 (binary heap, O(n) Vector copy). The queue is filled with
+    n keys and then runs a hold model (pop the front f, push f + x); every
+    "period" holds it takes a snapshot and plans on it: "depth" pops from
+    the snapshot, which must leave the live queue untouched. The fill and
+    the holds (with their snapshots and plans) are timed separately.
+
+    usage: pqbench-snapshot.x [n] [holds] [period] [depth]
+       n       queue size                           (default 100000)
+       holds   hold operations                      (default 100000)
+       period  holds between snapshots              (default 10)
+       depth   pops per plan                        (default 8)
+
+    Both queues must report the same checksum.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <chrono>
+
+#include <compare.h>   // generic lessthan and greaterthan predicates
+#include <pq.h>
+#include <pqbench.h>
+
+typedef unsigned long long            Key;
+typedef fsu::GreaterThan < Key >      PredicateType;   // smallest key first
+
+template < class Q >
+void Run (const char* implementation, size_t n, size_t holds, size_t period, size_t depth)
+{
+  pqb::Random r(4530);
+  Q q;
+  Key checksum = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < n; ++i)
+    q.Push(r.Next() % 1000000);
+  std::chrono::steady_clock::time_point filled = std::chrono::steady_clock::now();
+  for (size_t i = 1; i <= holds; ++i)
+  {
+    Key f = q.Front();
+    q.Pop();
+    q.Push(f + r.Next() % 1000);
+    if (i % period == 0)
+    {
+      Q plan = q;                              // the snapshot
+      for (size_t j = 0; j < depth && !plan.Empty(); ++j)
+      {
+        checksum = checksum * 31 + plan.Front();
+        plan.Pop();
+      }
+    }
+  }
+  std::chrono::steady_clock::time_point held = std::chrono::steady_clock::now();
+  while (!q.Empty())
+  {
+    checksum = checksum * 31 + q.Front();
+    q.Pop();
+  }
+  std::chrono::duration<double> fill = filled - start;
+  std::chrono::duration<double> hold = held - filled;
+
+  std::cout << std::left << std::setw(26) << implementation << std::right
+            << std::fixed << std::setprecision(1)
+            << "  fill " << std::setw(8) << 1e3 * fill.count() << " ms"
+            << "  hold " << std::setw(8) << (holds ? 1e9 * hold.count() / holds : 0.0)
+            << " ns/op"
+            << "   checksum " << checksum << '\n';
+}
+
+int main(int argc, char* argv[])
+{
+  size_t n      = (argc > 1) ? std::strtoul(argv[1], 0, 10) : 100000;
+  size_t holds  = (argc > 2) ? std::strtoul(argv[2], 0, 10) : 100000;
+  size_t period = (argc > 3) ? std::strtoul(argv[3], 0, 10) : 10;
+  size_t depth  = (argc > 4) ? std::strtoul(argv[4], 0, 10) : 8;
+  if (n == 0 || period == 0)
+  {
+    std::cout << "n and period must be positive - try again\n";
+    return EXIT_FAILURE;
+  }
+  std::cout << "n " << n << ", " << holds << " holds, a snapshot every " << period
+            << " with " << depth << " pops\n";
+  Run < pq6::PriorityQueue  < Key , PredicateType > > ("pq6: Vector, copy", n, holds, period, depth);
+  Run < pq15::PriorityQueue < Key , PredicateType > > ("pq15: persistent leftist", n, holds, period, depth);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,95 @@
+/*
+    pqbench-soa.cpp
+
+    Timing of pq11, which sifts only (key, slot) entries, against pq6,
+    which sifts whole elements, for a 200-byte element with an int
+    priority.
+
+    usage: pqbench-soa.x [size] [holds]
+       size   queue size                             (default 100000)
+       holds  pop-largest/push-random operations    (default 1000000)
+
+    Both queues must report the same checksum.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <chrono>
+
+#include <compare.h>   // generic lessthan and greaterthan predicates
+#include <pq.h>
+#include <pqbench.h>
+
+struct Record
+{
+  int  priority_;
+  char data_[196];
+};
+
+bool operator < (const Record& a, const Record& b)
+{
+  return a.priority_ < b.priority_;
+}
+
+std::ostream& operator << (std::ostream& os, const Record& r)
+{
+  return os << r.priority_;
+}
+
+class Priority
+{
+public:
+  int operator () (const Record& r) const
+  {
+    return r.priority_;
+  }
+};
+
+template < class Q >
+void Run (const char* implementation, size_t size, size_t holds)
+{
+  Q q;
+  pqb::Random r(4530);
+  Record x;
+  for (size_t i = 0; i < sizeof(x.data_); ++i)
+    x.data_[i] = static_cast<char>(i);
+  for (size_t i = 0; i < size; ++i)
+  {
+    x.priority_ = static_cast<int>(r.Bits(30));
+    q.Push(x);
+  }
+
+  unsigned long long checksum = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < holds; ++i)
+  {
+    checksum = checksum * 31 + q.Front().priority_ + q.Front().data_[i % sizeof(x.data_)];
+    q.Pop();
+    x.priority_ = static_cast<int>(r.Bits(30));
+    q.Push(x);
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  std::cout << std::setw(32) << std::left << implementation << std::right
+            << std::setw(10) << std::fixed << std::setprecision(1)
+            << 1e9 * elapsed.count() / holds << " ns/hold"
+            << "   checksum " << checksum << '\n';
+}
+
+int main(int argc, char* argv[])
+{
+  size_t size  = (argc > 1) ? std::strtoul(argv[1], 0, 10) : 100000;
+  size_t holds = (argc > 2) ? std::strtoul(argv[2], 0, 10) : 1000000;
+  if (size == 0)
+  {
+    std::cout << "size must be positive - try again\n";
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "queue size " << size << ", " << sizeof(Record) << "-byte elements\n";
+  Run < pq11::PriorityQueue < Record , Priority , fsu::LessThan < int > > >
+    ("pq11: (key,slot) heap + slots", size, holds);
+  Run < pq6::PriorityQueue < Record , fsu::LessThan < Record > > >
+    ("pq6: Vector, hole sifts", size, holds);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,92 @@
+/*
+    pqbench-static.cpp
+
+    Cost of short-lived small queues, as embedded in per-connection state:
+    construct a queue, push a handful of elements, pop them all, destroy
+    it; repeated millions of times. pq12::StaticPriorityQueue never
+    allocates; pq6 allocates as its fsu::Vector grows.
+
+    usage: pqbench-static.x [queues] [elements]
+       queues    number of queues constructed       (default 10000000)
+       elements  elements pushed into each, <= 64   (default 16)
+
+    Both runs must report the same checksum.
+
+    The static_assert below also checks that pq12 works in constant
+    expressions.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <chrono>
+
+#include <compare.h>   // generic lessthan and greaterthan predicates
+#include <pq.h>
+#include <pqbench.h>
+
+class Less
+// a predicate usable in constant expressions
+{
+public:
+  constexpr bool operator () (int a, int b) const
+  {
+    return a < b;
+  }
+};
+
+constexpr int SecondLargest (int a, int b, int c, int d)
+{
+  pq12::StaticPriorityQueue < int , Less , 4 > q;
+  q.Push(a);
+  q.Push(b);
+  q.Push(c);
+  q.Push(d);
+  if (q.TryPush(0)) return -1;   // full
+  q.Pop();
+  return q.Front();
+}
+
+static_assert(SecondLargest(3, 9, 4, 7) == 7, "pq12 in a constant expression");
+
+template < class Q >
+void Run (const char* implementation, size_t queues, size_t elements)
+{
+  pqb::Random r(4530);
+  unsigned long long checksum = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < queues; ++i)
+  {
+    Q q;
+    for (size_t j = 0; j < elements; ++j)
+      q.Push(static_cast<int>(r.Bits(30)));
+    while (!q.Empty())
+    {
+      checksum = checksum * 31 + q.Front();
+      q.Pop();
+    }
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  std::cout << std::setw(36) << std::left << implementation << std::right
+            << std::setw(10) << std::fixed << std::setprecision(1)
+            << 1e9 * elapsed.count() / queues << " ns/queue"
+            << "   checksum " << checksum << '\n';
+}
+
+int main(int argc, char* argv[])
+{
+  size_t queues   = (argc > 1) ? std::strtoul(argv[1], 0, 10) : 10000000;
+  size_t elements = (argc > 2) ? std::strtoul(argv[2], 0, 10) : 16;
+  if (elements > 64)
+  {
+    std::cout << "elements must be at most 64 - try again\n";
+    return EXIT_FAILURE;
+  }
+
+  std::cout << queues << " queues of " << elements << " elements\n";
+  Run < pq12::StaticPriorityQueue < int , fsu::LessThan < int > , 64 > >
+    ("pq12: StaticPriorityQueue<64>", queues, elements);
+  Run < pq6::PriorityQueue < int , fsu::LessThan < int > > >
+    ("pq6: Vector, hole sifts", queues, elements);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,167 @@
+/*
+    pqbench-timer.cpp
+
+    Timer churn on the timing wheel tw::TimingWheel against a pq6 heap of
+    deadlines with lazy cancellation, both driven by the same trace.
+
+    Each tick the trace schedules a burst of timers with random timeouts,
+    cancels most pending timers before they expire (as a timer service
+    does when replies arrive in time), and advances the clock one tick.
+
+    usage: pqbench-timer.x [ticks] [per-tick] [max-timeout] [cancel%]
+       ticks        number of clock ticks           (default 100000)
+       per-tick     timers scheduled per tick       (default 100)
+       max-timeout  timeouts are 1..max-timeout     (default 5000)
+       cancel%      percent of timers cancelled     (default 90)
+
+    Both runs must report the same number of fired timers and checksum.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <chrono>
+
+#include <vector.h>
+#include <pq.h>
+#include <twheel.h>
+#include <pqbench.h>
+
+struct Result
+{
+  size_t             fired_;
+  unsigned long long checksum_;
+  Result() : fired_(0), checksum_(0) {}
+};
+
+class Fire
+{
+public:
+  explicit Fire(Result& r) : r_(&r) {}
+  void operator () (size_t id) const
+  {
+    ++r_->fired_;
+    r_->checksum_ += id * 2654435761ULL;
+  }
+private:
+  Result* r_;
+};
+
+// ----------------------------------------------------------------------
+// heap of deadlines: Cancel marks the id dead, expiry skips dead entries
+
+struct Entry
+{
+  tw::Tick deadline_;
+  size_t   id_;
+};
+
+class Later
+{
+public:
+  bool operator () (const Entry& a, const Entry& b) const
+  {
+    return a.deadline_ > b.deadline_;
+  }
+};
+
+class HeapTimers
+{
+public:
+  typedef size_t Handle;
+  HeapTimers() : now_(0) {}
+  Handle Schedule (tw::Tick deadline, size_t id)
+  {
+    Entry e;
+    e.deadline_ = deadline;
+    e.id_ = id;
+    if (dead_.Size() <= id) dead_.SetSize(id + 1);
+    dead_[id] = 0;
+    q_.Push(e);
+    return id;
+  }
+  bool Cancel (Handle id)
+  {
+    dead_[id] = 1;
+    return true;
+  }
+  template <class F>
+  void Advance (tw::Tick now, F callback)
+  {
+    now_ = now;
+    while (!q_.Empty() && q_.Front().deadline_ <= now_)
+    {
+      size_t id = q_.Front().id_;
+      q_.Pop();
+      if (!dead_[id]) callback(id);
+    }
+  }
+  size_t HeapSize () const { return q_.Size(); }
+private:
+  pq6::PriorityQueue < Entry , Later > q_;
+  fsu::Vector < char > dead_;   // 1 = cancelled
+  tw::Tick now_;
+};
+
+// ----------------------------------------------------------------------
+
+template < class Timers >
+void Run (const char* implementation, size_t ticks, size_t perTick,
+          size_t maxTimeout, size_t cancel)
+{
+  // a cancelled timer gets its cancel tick when it is scheduled, somewhere
+  // in [now, deadline); cancelAt is a ring of those ticks
+  Timers timers;
+  fsu::Vector < typename Timers::Handle > handle;
+  fsu::Vector < fsu::Vector < size_t > > cancelAt;
+  cancelAt.SetSize(maxTimeout + 1);
+  Result result;
+  pqb::Random r(4530);
+  size_t next = 0, cancelled = 0;
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (tw::Tick now = 1; now <= ticks; ++now)
+  {
+    for (size_t k = 0; k < perTick; ++k, ++next)
+    {
+      size_t timeout = 1 + r.Next(maxTimeout);
+      handle.PushBack(timers.Schedule(now + timeout, next));
+      if (r.Next(100) < cancel)
+        cancelAt[(now + r.Next(timeout)) % cancelAt.Size()].PushBack(next);
+    }
+    fsu::Vector < size_t > & due = cancelAt[now % cancelAt.Size()];
+    for (size_t k = 0; k < due.Size(); ++k)
+      timers.Cancel(handle[due[k]]);
+    cancelled += due.Size();
+    due.Clear();
+    timers.Advance(now, Fire(result));
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  size_t ops = next + cancelled + ticks;
+  std::cout << std::setw(28) << std::left << implementation << std::right
+            << std::setw(10) << std::fixed << std::setprecision(3) << elapsed.count() << " s"
+            << std::setw(10) << std::setprecision(1) << 1e9 * elapsed.count() / ops << " ns/op"
+            << "   fired " << result.fired_
+            << "   checksum " << result.checksum_ << '\n';
+}
+
+int main(int argc, char* argv[])
+{
+  size_t ticks      = (argc > 1) ? std::strtoul(argv[1], 0, 10) : 100000;
+  size_t perTick    = (argc > 2) ? std::strtoul(argv[2], 0, 10) : 100;
+  size_t maxTimeout = (argc > 3) ? std::strtoul(argv[3], 0, 10) : 5000;
+  size_t cancel     = (argc > 4) ? std::strtoul(argv[4], 0, 10) : 90;
+  if (maxTimeout == 0 || cancel > 100)
+  {
+    std::cout << "max-timeout must be positive and cancel% at most 100 - try again\n";
+    return EXIT_FAILURE;
+  }
+
+  std::cout << ticks << " ticks, " << perTick << " timers/tick, timeouts 1.."
+            << maxTimeout << ", " << cancel << "% cancelled\n";
+
+  Run < tw::TimingWheel < size_t > > ("tw: TimingWheel<6,4>", ticks, perTick, maxTimeout, cancel);
+  Run < HeapTimers >                 ("pq6: Vector, lazy cancel",  ticks, perTick, maxTimeout, cancel);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,119 @@
+/*
+    pqbench-weakheap.cpp
+
+    Comparisons and time of pq14 (weak heap) against pq6 (binary heap)
+    when comparing is expensive: every element is a (rank, path) pair with
+    few distinct ranks, so most comparisons fall through to a string
+    comparison of paths sharing a long prefix. The predicate counts its
+    calls.
+
+    workload   operations (n = size)
+    --------   ----------
+    sort       n pushes, then drain
+    hold       n pushes, n holds (pop the front, push a new element), then
+               drain
+
+    usage: pqbench-weakheap.x [n]
+       n   size                                        (default 200000)
+
+    Both queues must report the same checksum for each workload.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <cstdlib>
+#include <chrono>
+
+#include <pq.h>
+#include <pqbench.h>
+
+struct Job
+{
+  unsigned    rank_;
+  std::string path_;
+};
+
+unsigned long long compares = 0;
+
+class CountingLess
+// rank, then path
+{
+public:
+  bool operator () (const Job& a, const Job& b) const
+  {
+    ++compares;
+    if (a.rank_ != b.rank_) return a.rank_ < b.rank_;
+    return a.path_ < b.path_;
+  }
+};
+
+Job Make (pqb::Random& r)
+{
+  Job j;
+  unsigned long long x = r.Next();
+  j.rank_ = static_cast<unsigned>(x & 15);
+  j.path_ = "/var/spool/queue/batch/jobs/" + std::to_string((x >> 4) % 1000000000);
+  return j;
+}
+
+unsigned long long Digest (unsigned long long h, const Job& j)
+{
+  h = h * 31 + j.rank_;
+  for (size_t i = 0; i < j.path_.size(); ++i)
+    h = h * 31 + static_cast<unsigned char>(j.path_[i]);
+  return h;
+}
+
+template < class Q >
+void Run (const char* implementation, const char* workload, size_t n)
+{
+  pqb::Random r(4530);
+  Q q;
+  unsigned long long checksum = 0;
+  size_t ops = 0;
+  compares = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < n; ++i, ++ops)
+    q.Push(Make(r));
+  if (workload[0] == 'h')
+  {
+    for (size_t i = 0; i < n; ++i, ops += 2)
+    {
+      checksum = Digest(checksum, q.Front());
+      q.Pop();
+      q.Push(Make(r));
+    }
+  }
+  while (!q.Empty())
+  {
+    checksum = Digest(checksum, q.Front());
+    q.Pop();
+    ++ops;
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  std::cout << std::left << std::setw(16) << implementation
+            << std::setw(6) << workload << std::right
+            << std::fixed << std::setprecision(2)
+            << std::setw(10) << static_cast<double>(compares) / ops << " cmp/op"
+            << std::setw(10) << std::setprecision(1) << 1e9 * elapsed.count() / ops << " ns/op"
+            << "   checksum " << checksum << '\n';
+}
+
+int main(int argc, char* argv[])
+{
+  size_t n = (argc > 1) ? std::strtoul(argv[1], 0, 10) : 200000;
+  if (n == 0)
+  {
+    std::cout << "n must be positive - try again\n";
+    return EXIT_FAILURE;
+  }
+  const char* workloads[] = { "sort", "hold" };
+  for (size_t w = 0; w < 2; ++w)
+  {
+    Run < pq6::PriorityQueue  < Job , CountingLess > > ("pq6: binary", workloads[w], n);
+    Run < pq14::PriorityQueue < Job , CountingLess > > ("pq14: weak", workloads[w], n);
+  }
+  return EXIT_SUCCESS;
+}
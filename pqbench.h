@@ -0,0 +1,58 @@
+/*
+  pqbench.h
+
+  pqb::Random
+
+  The random numbers of the pqbench-*.cpp programs: a small linear
+  congruential generator (Knuth's MMIX constants), so that every queue a
+  benchmark compares sees exactly the same keys and operations, and a run
+  is repeated exactly from its seed.
+
+    pqb::Random r(4530);
+    r.Next()          48 random bits
+    r.Next(range)     in [0, range)
+    r.Bits(b)         b random bits, 0 < b <= 64
+    r.Exponential()   exponentially distributed, mean 1
+*/
+
+#ifndef _PQBENCH_H
+#define _PQBENCH_H
+
+#include <cmath>       // std::log()
+
+namespace pqb
+{
+ class Random
+ {
+ public:
+  explicit Random(unsigned long long seed) : s_(seed)
+  {}
+
+  unsigned long long Next ()
+  {
+    return Bits(48);
+  }
+
+  unsigned long long Next (unsigned long long range)
+  {
+    return Bits(48) % range;
+  }
+
+  unsigned long long Bits (unsigned b)
+  // the high bits of the state: the low ones of an LCG are poor
+  {
+    s_ = s_ * 6364136223846793005ULL + 1442695040888963407ULL;
+    return s_ >> (64 - b);
+  }
+
+  double Exponential ()
+  {
+    return -std::log((static_cast<double>(Bits(53)) + 0.5) / 9007199254740992.0);
+  }
+
+ private:
+  unsigned long long s_;
+ };
+} // namespace pqb
+
+#endif
@@ -0,0 +1,192 @@
+/*
+    pqcrashtest.cpp
+
+    Crash injection for pqd::DurableQueue (pqdurable.h). Every round a
+    child process opens the queue and runs operations on it until it is
+    killed, and the parent reopens the queue and checks it:
+      - the heap property holds over the whole array (read with Dump)
+      - the contents are those of a pq6 that ran the same operations,
+        as many as the queue's sequence number says were applied
+    Operation i is a function of i alone (a push of a hashed key, or a pop
+    one time in three), so the parent can follow the child in its own pq6
+    without any other channel.
+
+    The kills come three ways, in turn:
+      timed    SIGKILL from the parent after a random delay
+      flush    the same, with sync Flush, whose msyncs make a kill between
+               the log and the header common
+      inside   the child kills itself at a random PQD_CRASH_POINT: after
+               the stores of a log record, between the two halves of its
+               header, or part way through the stores of an operation,
+               where only the replay on reopen can restore the heap
+
+    A killed process leaves everything it wrote in the page cache, so none
+    of this is a power failure: it checks the order of the writes, not
+    which of them reach the disk. The replay of a record equal to the
+    header's sequence number, which covers the array pages lost in a power
+    failure, is only exercised as a no-op here.
+
+    usage: pqcrashtest.x [rounds] [path]
+       rounds  kills                                     (default 100)
+       path    queue file, removed at the end            (default pqcrashtest.dat)
+
+    Prints a line every 10 rounds, then "OK" or the first failure.
+*/
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+
+#include <signal.h>    // kill()
+#include <sys/wait.h>  // waitpid()
+#include <unistd.h>    // fork(), usleep(), _exit()
+
+// the child counts crash points down to its own death
+static unsigned long countdown = 0;
+#define PQD_CRASH_POINT() if (countdown > 0 && --countdown == 0) raise(SIGKILL)
+
+#include <compare.h>   // generic lessthan and greaterthan predicates
+#include <pq.h>
+#include <pqdurable.h>
+
+typedef unsigned long long                          Key;
+typedef fsu::LessThan < Key >                       PredicateType;
+typedef pqd::DurableQueue < Key , PredicateType >   DurableQueue;
+typedef pq6::PriorityQueue < Key , PredicateType >  MemoryQueue;
+
+// splitmix64: operation i of every run
+Key Mix (unsigned long long i)
+{
+  unsigned long long z = i * 0x9E3779B97F4A7C15ULL;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+template < class Q >
+void Operate (Q& q, unsigned long long i)
+{
+  Key m = Mix(i);
+  if (m % 3 == 0 && !q.Empty())
+    q.Pop();
+  else
+    q.Push(m >> 40);
+}
+
+void Child (const char* path, pqd::Sync sync, unsigned long crash)
+{
+  countdown = crash;
+  DurableQueue q;
+  if (!q.Open(path, sync)) _exit(EXIT_FAILURE);
+  for (unsigned long long i = q.Sequence() + 1; ; ++i)
+    Operate(q, i);
+}
+
+// reopen the queue after a kill, bring the mirror up to the same
+// operation, and compare
+bool Check (const char* path, MemoryQueue& mirror, unsigned long long& applied, bool& replayed)
+{
+  DurableQueue q;
+  if (!q.Open(path))
+  {
+    std::cout << "reopen failed\n";
+    return false;
+  }
+  replayed = q.Replayed();
+  if (q.Sequence() < applied)
+  {
+    std::cout << "sequence went back from " << applied << " to " << q.Sequence() << '\n';
+    return false;
+  }
+  while (applied < q.Sequence())
+    Operate(mirror, ++applied);
+  if (q.Size() != mirror.Size())
+  {
+    std::cout << "operation " << applied << ": size " << q.Size()
+              << ", expected " << mirror.Size() << '\n';
+    return false;
+  }
+
+  std::stringstream ss;
+  q.Dump(ss, ' ');
+  std::vector < Key > a;
+  Key k;
+  while (ss >> k) a.push_back(k);
+  if (a.size() != q.Size())
+  {
+    std::cout << "Dump gave " << a.size() << " of " << q.Size() << " elements\n";
+    return false;
+  }
+  for (size_t c = 1; c < a.size(); ++c)
+  {
+    if (a[(c - 1) / 2] < a[c])
+    {
+      std::cout << "operation " << applied << ": heap order broken at " << c << '\n';
+      return false;
+    }
+  }
+  std::sort(a.begin(), a.end());
+  MemoryQueue copy(mirror);
+  for (size_t i = a.size(); i-- > 0; copy.Pop())
+  {
+    if (a[i] != copy.Front())
+    {
+      std::cout << "operation " << applied << ": contents differ from pq6\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+int main(int argc, char* argv[])
+{
+  size_t      rounds = (argc > 1) ? std::strtoul(argv[1], 0, 10) : 100;
+  const char* path   = (argc > 2) ? argv[2] : "pqcrashtest.dat";
+
+  DurableQueue::Remove(path);
+  MemoryQueue mirror;
+  unsigned long long applied = 0;
+  size_t replays = 0;
+  srand(4530);
+  for (size_t round = 1; round <= rounds; ++round)
+  {
+    int way = round % 3;                       // 1 timed, 2 flush, 0 inside
+    pqd::Sync sync = way == 2 ? pqd::Flush : pqd::None;
+    unsigned long crash = way == 0 ? 1 + rand() % 200000 : 0;
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+      std::cout << "fork failed\n";
+      return EXIT_FAILURE;
+    }
+    if (pid == 0) Child(path, sync, crash);
+    if (crash == 0)
+    {
+      usleep(1000 + rand() % (sync == pqd::Flush ? 50000 : 20000));
+      kill(pid, SIGKILL);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    if (WIFEXITED(status))
+    {
+      std::cout << "round " << round << ": the child could not open " << path << '\n';
+      return EXIT_FAILURE;
+    }
+
+    bool replayed;
+    if (!Check(path, mirror, applied, replayed))
+    {
+      std::cout << "FAILED in round " << round << '\n';
+      return EXIT_FAILURE;
+    }
+    replays += replayed;
+    if (round % 10 == 0)
+      std::cout << "round " << round << ": " << applied << " operations, size "
+                << mirror.Size() << ", " << replays << " replayed on reopen\n";
+  }
+  DurableQueue::Remove(path);
+  std::cout << "OK\n";
+  return EXIT_SUCCESS;
+}
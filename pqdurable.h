@@ -0,0 +1,493 @@
+/*
+  pqdurable.h
+
+  pqd::DurableQueue < T , P >
+
+  pq6's heap in a memory-mapped file, kept crash consistent by a one-record
+  write-ahead log, so that a restarted process reopens its queue in O(1)
+  (map the file, replay at most one record) instead of pushing everything
+  again from an external source:
+
+    pqd::DurableQueue < Event , EventLess > q;
+    if (!q.Open("sched.pq")) ...     // sched.pq and sched.pq.wal, made if missing
+    q.Push(e);  q.Front();  q.Pop();  // as pq6
+    q.Close();                        // or exit, or crash
+
+  Files
+    path        a 4 KB header (magic, sizeof(T), size, sequence number of
+                the last operation applied) and the heap array behind it;
+                the file grows by doubling (ftruncate, then remap)
+    path.wal    one record: the sequence number, the new size, and every
+                (index, value) store the operation makes to the array,
+                with a checksum
+
+  Every Push, Pop and Clear first works out its stores without making
+  them (hole-based sift up, bottom-up Pop, as pq6), writes them to the log
+  record with its checksum, then makes them in the array, then advances
+  the sequence number in the header. On Open a log record that is intact
+  and one past the header's sequence number is applied again: the crash
+  came between the log and the header, and the stores are idempotent. An
+  intact record equal to the header's sequence number is applied again
+  too: after a power failure the header page may be on disk while some
+  page of the array is not. A torn record fails its checksum, and then the
+  array was never touched.
+
+  Open reads the header before it writes anything: a file that holds a
+  queue of another sizeof(T), or is not a queue file at all, is refused
+  and left as it is. Only an empty file, or one whose header was never
+  completed by an earlier Open, is made into an empty queue.
+
+  Both files are mapped MAP_SHARED, so the log and the array are in the
+  page cache as soon as they are written: with sync None the queue
+  survives the death of the process (kill -9, abort, a crash) at the cost
+  of a checksum and a second copy of the O(log n) stores. With sync Flush
+  it also survives the machine: msync of the log before the stores, and
+  of the touched pages after them, two disk flushes per operation;
+  pqjournal.h shares one flush among many operations (group commit).
+
+  T must be trivially copyable: it is written to the files as bytes, and
+  a file is reopened only with the same sizeof(T). P is not stored.
+*/
+
+#ifndef _PQDURABLE_H
+#define _PQDURABLE_H
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <iostream>
+#include <new>          // std::bad_alloc
+#include <atomic>       // std::atomic_signal_fence()
+#include <type_traits>  // std::is_trivially_copyable<>
+#include <fcntl.h>      // open()
+#include <unistd.h>     // ftruncate(), close(), unlink()
+#include <sys/mman.h>   // mmap(), munmap(), msync()
+#include <sys/stat.h>   // fstat()
+
+// crash injection: pqcrashtest.cpp defines this to kill the process at
+// the points in between the stores of an operation
+#ifndef PQD_CRASH_POINT
+#define PQD_CRASH_POINT()
+#endif
+
+namespace pqd
+{
+ enum Sync { None, Flush };
+
+ // FNV-1a, 64 bits, a word at a time: enough to tell a torn record
+ inline unsigned long long Checksum (const void* p, size_t n,
+                                     unsigned long long h = 14695981039346656037ULL)
+ {
+   const unsigned char* b = static_cast<const unsigned char*>(p);
+   unsigned long long w;
+   for (; n >= sizeof(w); n -= sizeof(w), b += sizeof(w))
+   {
+     std::memcpy(&w, b, sizeof(w));
+     h = (h ^ w) * 1099511628211ULL;
+   }
+   for (; n > 0; --n, ++b)
+     h = (h ^ *b) * 1099511628211ULL;
+   return h;
+ }
+
+ template <typename T, class P>
+ class DurableQueue
+ {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "pqd::DurableQueue: T is written to the file as bytes");
+
+  // Push(t): stores of a hole-based sift up, logged, then applied
+  // Front(): v[0], in the mapped file
+  // Pop()  : stores of a bottom-up sift of the last leaf, logged, then applied
+
+  struct Header
+  {
+    unsigned long long magic_;
+    unsigned long long element_;       // sizeof(T)
+    unsigned long long size_;
+    unsigned long long sequence_;      // of the last operation applied
+  };
+
+  struct Store
+  {
+    unsigned long long index_;
+    T                  value_;
+  };
+
+  struct Record
+  {
+    unsigned long long checksum_;      // of everything after it
+    unsigned long long sequence_;
+    unsigned long long size_;          // after the operation
+    unsigned long long count_;         // stores that follow
+  };
+
+  static const unsigned long long Magic   = 0x3144515044ULL;    // "DPQD1"
+  static const size_t             Offset  = 4096;                // of the array
+  static const size_t             Initial = 1024;                // elements
+  static const size_t             Stores  = 64 + 1;              // per operation, at most
+
+  P             p_;
+  std::string   path_;
+  Sync          sync_;
+  int           fd_;
+  char*         data_;
+  size_t        bytes_;
+  char*         log_;
+  size_t        capacity_;
+  bool          replayed_;
+  Store         w_[Stores];            // the stores of the operation under way
+  size_t        n_;
+
+ public:
+
+  typedef T ValueType;
+  typedef P PredicateType;
+
+  DurableQueue() : p_(), sync_(None), fd_(-1), data_(0), bytes_(0), log_(0),
+                   capacity_(0), replayed_(false), n_(0)
+  {}
+
+  explicit DurableQueue(P p) : p_(p), sync_(None), fd_(-1), data_(0), bytes_(0), log_(0),
+                               capacity_(0), replayed_(false), n_(0)
+  {}
+
+  ~DurableQueue()
+  {
+    Close();
+  }
+
+  bool Open (const char* path, Sync sync = None)
+  // open path and path.wal, made empty if missing; false if they cannot
+  // be opened, hold another sizeof(T), or are not a queue
+  {
+    Close();
+    path_ = path;
+    sync_ = sync;
+    replayed_ = false;
+    fd_ = ::open(path, O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0) return false;
+    struct stat st;
+    Header head;
+    std::memset(&head, 0, sizeof(head));
+    size_t bytes = 0;
+    bool ok = ::fstat(fd_, &st) == 0;
+    if (ok)
+    {
+      bytes = static_cast<size_t>(st.st_size);
+      ok = bytes == 0 || (bytes >= sizeof(Header)
+                          && ::pread(fd_, &head, sizeof(head), 0) == sizeof(head));
+    }
+    if (ok && head.magic_ == Magic)
+      ok = head.element_ == sizeof(T) && bytes >= Offset + Initial * sizeof(T)
+           && head.size_ <= (bytes - Offset) / sizeof(T);
+    else if (ok)
+      // new, or made by an Open that did not finish: nothing but the
+      // zeros of ftruncate and the fields written before the magic
+      ok = head.magic_ == 0 && head.size_ == 0 && head.sequence_ == 0
+           && (head.element_ == 0 || head.element_ == sizeof(T));
+    if (ok && bytes < Offset + Initial * sizeof(T))
+    {
+      bytes = Offset + Initial * sizeof(T);
+      ok = ::ftruncate(fd_, static_cast<off_t>(bytes)) == 0;
+    }
+    if (!ok || !OpenLog() || !Map(bytes))
+    {
+      Close();
+      return false;
+    }
+    Header* h = Head();
+    if (h->magic_ == 0)
+    {
+      h->element_  = sizeof(T);
+      h->size_     = 0;
+      h->sequence_ = 0;
+      Record* r = Log();
+      std::memset(r, 0, sizeof(Record));      // no record to replay
+      Fence();
+      h->magic_ = Magic;
+      if (sync_ == Flush)
+      {
+        ::msync(log_, LogBytes(), MS_SYNC);
+        ::msync(data_, Offset, MS_SYNC);
+      }
+    }
+    Replay();
+    return true;
+  }
+
+  void Close ()
+  {
+    if (data_ != 0) ::munmap(data_, bytes_);
+    if (log_ != 0)  ::munmap(log_, LogBytes());
+    if (fd_ >= 0)   ::close(fd_);
+    data_ = log_ = 0;
+    fd_ = -1;
+    bytes_ = capacity_ = 0;
+  }
+
+  static bool Remove (const char* path)
+  // delete the files of a closed queue
+  {
+    bool ok = ::unlink(path) == 0;
+    return ::unlink((std::string(path) + ".wal").c_str()) == 0 && ok;
+  }
+
+  bool Good () const
+  {
+    return data_ != 0;
+  }
+
+  bool Replayed () const
+  // Open found a logged operation missing from the array, and made it
+  {
+    return replayed_;
+  }
+
+  unsigned long long Sequence () const
+  // operations applied since the file was made
+  {
+    return Head()->sequence_;
+  }
+
+  void Push (const T& t)
+  // O(log n)
+  {
+    size_t c = Size();
+    if (c == capacity_) Grow();
+    const T* a = Array();
+    n_ = 0;
+    while (c > 0)
+    {
+      size_t p = (c - 1) / 2;
+      if (!p_(a[p], t)) break;
+      Set(c, a[p]);
+      c = p;
+    }
+    Set(c, t);
+    Commit(Size() + 1);
+  }
+
+  void Pop ()
+  // O(log n)
+  {
+    size_t n = Size() - 1;
+    const T* a = Array();
+    n_ = 0;
+    size_t x = 0, c;
+    while ((c = 2 * x + 1) < n)
+    {
+      if (c + 1 < n && p_(a[c], a[c + 1])) ++c;
+      Set(x, a[c]);
+      x = c;
+    }
+    // w_ now holds the path, one store per level: sift the last leaf up
+    // it by moving the values, not the indices
+    const T last = a[n];
+    Set(x, last);
+    for (size_t k = n_ - 1; k > 0 && p_(w_[k - 1].value_, last); --k)
+    {
+      w_[k].value_ = w_[k - 1].value_;
+      w_[k - 1].value_ = last;
+    }
+    Commit(n);
+  }
+
+  const T& Front () const
+  // O(1)
+  {
+    return Array()[0];
+  }
+
+  void Clear ()
+  {
+    n_ = 0;
+    Commit(0);
+  }
+
+  bool Empty () const
+  {
+    return Size() == 0;
+  }
+
+  size_t Size () const
+  {
+    return static_cast<size_t>(Head()->size_);
+  }
+
+  size_t Capacity () const
+  {
+    return capacity_;
+  }
+
+  P GetPredicate() const
+  {
+    return p_;
+  }
+
+  void Dump (std::ostream& os, char ofc = '\0') const
+  {
+    const T* a = Array();
+    for (size_t i = 0; i < Size(); ++i)
+    {
+      os << a[i];
+      if (ofc != '\0') os << ofc;
+    }
+  }
+
+ private:
+  DurableQueue(const DurableQueue&);               // one mapping per file
+  DurableQueue& operator = (const DurableQueue&);
+
+  Header* Head () const
+  {
+    return reinterpret_cast<Header*>(data_);
+  }
+
+  T* Array () const
+  {
+    return reinterpret_cast<T*>(data_ + Offset);
+  }
+
+  Record* Log () const
+  {
+    return reinterpret_cast<Record*>(log_);
+  }
+
+  Store* LogStores () const
+  {
+    return reinterpret_cast<Store*>(log_ + sizeof(Record));
+  }
+
+  static size_t LogBytes ()
+  {
+    return sizeof(Record) + Stores * sizeof(Store);
+  }
+
+  static void Fence ()
+  // keep the compiler from moving stores to one mapping past stores to
+  // the other: a killed process leaves the page cache in program order
+  {
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+  }
+
+  bool Map (size_t bytes)
+  {
+    void* m = ::mmap(0, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (m == MAP_FAILED) return false;
+    if (data_ != 0) ::munmap(data_, bytes_);
+    data_ = static_cast<char*>(m);
+    bytes_ = bytes;
+    capacity_ = (bytes - Offset) / sizeof(T);
+    return true;
+  }
+
+  bool OpenLog ()
+  {
+    int fd = ::open((path_ + ".wal").c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) return false;
+    struct stat st;
+    bool ok = ::fstat(fd, &st) == 0
+              && (static_cast<size_t>(st.st_size) == LogBytes()
+                  || ::ftruncate(fd, static_cast<off_t>(LogBytes())) == 0);
+    void* m = ok ? ::mmap(0, LogBytes(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    ::close(fd);
+    if (m == MAP_FAILED) return false;
+    log_ = static_cast<char*>(m);
+    return true;
+  }
+
+  void Grow ()
+  // double the file; the new space is zeros, and no store refers to it
+  // until the next record
+  {
+    size_t bytes = Offset + 2 * capacity_ * sizeof(T);
+    if (::ftruncate(fd_, static_cast<off_t>(bytes)) != 0 || !Map(bytes))
+      throw std::bad_alloc();
+  }
+
+  void Set (size_t i, const T& t)
+  {
+    w_[n_].index_ = i;
+    w_[n_].value_ = t;
+    ++n_;
+  }
+
+  unsigned long long Sum (const Record& r, const Store* s) const
+  {
+    unsigned long long h = Checksum(&r.sequence_, sizeof(Record) - sizeof(r.checksum_));
+    return Checksum(s, static_cast<size_t>(r.count_) * sizeof(Store), h);
+  }
+
+  void Commit (size_t size)
+  // log the stores in w_, then make them
+  {
+    Record* r = Log();
+    Store*  s = LogStores();
+    Record  next;
+    next.sequence_ = Head()->sequence_ + 1;
+    next.size_     = size;
+    next.count_    = n_;
+    std::memcpy(static_cast<void*>(s), w_, n_ * sizeof(Store));
+    next.checksum_ = Sum(next, w_);
+    PQD_CRASH_POINT();
+    // the record header in two halves, as a crash may leave it: checksum
+    // and sequence number first, then size and count
+    const size_t half = 2 * sizeof(unsigned long long);
+    std::memcpy(static_cast<void*>(r), &next, half);
+    Fence();
+    PQD_CRASH_POINT();
+    std::memcpy(reinterpret_cast<char*>(r) + half,
+                reinterpret_cast<const char*>(&next) + half, sizeof(Record) - half);
+    Fence();
+    if (sync_ == Flush) ::msync(log_, LogBytes(), MS_SYNC);
+    Apply(next, w_);
+  }
+
+  void Apply (const Record& r, const Store* s)
+  {
+    T* a = Array();
+    for (size_t k = 0; k < r.count_; ++k)
+    {
+      a[s[k].index_] = s[k].value_;
+      PQD_CRASH_POINT();
+    }
+    Header* h = Head();
+    h->size_ = r.size_;
+    Fence();
+    h->sequence_ = r.sequence_;
+    if (sync_ == Flush) FlushStores(r, s);
+  }
+
+  void FlushStores (const Record& r, const Store* s)
+  // msync from the header to the last store: every page in between that
+  // is dirty was dirtied by this operation
+  {
+    size_t end = Offset;
+    for (size_t k = 0; k < r.count_; ++k)
+      if (Offset + (s[k].index_ + 1) * sizeof(T) > end)
+        end = Offset + (s[k].index_ + 1) * sizeof(T);
+    ::msync(data_, end, MS_SYNC);
+  }
+
+  void Replay ()
+  // the record one past the header: the crash came before the header was
+  // written; the record equal to it: applied, but after a power failure
+  // some of its stores may not have reached the disk
+  {
+    Header* h = Head();
+    Record  r;
+    std::memcpy(&r, Log(), sizeof(Record));
+    if ((r.sequence_ != h->sequence_ + 1 && r.sequence_ != h->sequence_)
+        || r.count_ > Stores || r.size_ > capacity_ || Sum(r, LogStores()) != r.checksum_)
+      return;
+    for (size_t k = 0; k < r.count_; ++k)
+      if (LogStores()[k].index_ >= capacity_) return;
+    bool missing = r.sequence_ == h->sequence_ + 1;
+    Apply(r, LogStores());
+    replayed_ = missing;
+  }
+ };
+} // namespace pqd
+
+#endif
@@ -0,0 +1,190 @@
+/*
+  pqio.h
+
+  pqio::MappedFile, pqio::Writer
+
+  Fast file input and console output for the batch drivers.
+
+  MappedFile maps a whole file read-only and hands it out as one buffer
+  [Begin(), End()), so a command file is parsed in place with no stream
+  extraction and no copying.
+
+  Writer collects output in one buffer and hands it to write(2) only when
+  the buffer is full, on Flush(), and on destruction. Put() covers the
+  characters, strings and integers the drivers print; Writer is also a
+  std::streambuf, so that an operator<< (for example a Dump()) can write
+  through it with an std::ostream:
+
+    pqio::Writer out(1);          // standard output
+    std::ostream os(&out);
+    out.Put("Q size is "); out.Put(n); out.Put('\n');
+    Q.Dump(os, '\n');
+
+  Do not mix a Writer with std::cout on the same descriptor without a
+  Flush() in between.
+*/
+
+#ifndef _PQIO_H
+#define _PQIO_H
+
+#include <cstddef>
+#include <cstring>
+#include <cerrno>       // errno, EINTR
+#include <streambuf>
+#include <fcntl.h>      // open()
+#include <unistd.h>     // read(), write(), close()
+#include <sys/mman.h>   // mmap(), munmap(), madvise()
+#include <sys/stat.h>   // fstat()
+
+namespace pqio
+{
+ class MappedFile
+ {
+ public:
+  explicit MappedFile(const char* name) : fd_(-1), data_(0), size_(0), good_(false)
+  {
+    fd_ = ::open(name, O_RDONLY);
+    if (fd_ < 0) return;
+    struct stat st;
+    if (::fstat(fd_, &st) != 0) return;
+    size_ = static_cast<size_t>(st.st_size);
+    good_ = true;
+    if (size_ == 0) return;
+    void* p = ::mmap(0, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (p == MAP_FAILED)
+    {
+      good_ = false;
+      size_ = 0;
+      return;
+    }
+    ::madvise(p, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const char*>(p);
+  }
+
+  ~MappedFile()
+  {
+    if (data_ != 0) ::munmap(const_cast<char*>(data_), size_);
+    if (fd_ >= 0)   ::close(fd_);
+  }
+
+  bool        Good  () const { return good_; }
+  const char* Begin () const { return data_; }
+  const char* End   () const { return data_ + size_; }
+  size_t      Size  () const { return size_; }
+
+ private:
+  int         fd_;
+  const char* data_;
+  size_t      size_;
+  bool        good_;
+
+  MappedFile(const MappedFile&);
+  MappedFile& operator = (const MappedFile&);
+ };
+
+ class Writer : public std::streambuf
+ {
+ public:
+  explicit Writer(int fd) : fd_(fd), n_(0)
+  {}
+
+  ~Writer()
+  {
+    Flush();
+  }
+
+  void Put (char c)
+  {
+    if (n_ == Capacity) Flush();
+    b_[n_++] = c;
+  }
+
+  void Put (const char* s, size_t n)
+  {
+    if (n_ + n > Capacity)
+    {
+      Flush();
+      if (n > Capacity)
+      {
+        Drain(s, n);
+        return;
+      }
+    }
+    std::memcpy(b_ + n_, s, n);
+    n_ += n;
+  }
+
+  void Put (const char* s)
+  {
+    Put(s, std::strlen(s));
+  }
+
+  void Put (long long v)
+  {
+    char d[24];
+    size_t i = sizeof(d);
+    unsigned long long u = v < 0 ? 0ULL - static_cast<unsigned long long>(v)
+                                 : static_cast<unsigned long long>(v);
+    do { d[--i] = static_cast<char>('0' + u % 10); u /= 10; } while (u != 0);
+    if (v < 0) d[--i] = '-';
+    Put(d + i, sizeof(d) - i);
+  }
+
+  void Put (int v)           { Put(static_cast<long long>(v)); }
+  void Put (long v)          { Put(static_cast<long long>(v)); }
+  void Put (size_t v)        { Put(static_cast<long long>(v)); }
+
+  void Flush ()
+  {
+    Drain(b_, n_);
+    n_ = 0;
+  }
+
+ protected:
+  // std::streambuf: unbuffered on the streambuf side, buffered here
+  int_type overflow (int_type c)
+  {
+    if (!traits_type::eq_int_type(c, traits_type::eof()))
+      Put(traits_type::to_char_type(c));
+    return traits_type::not_eof(c);
+  }
+
+  std::streamsize xsputn (const char* s, std::streamsize n)
+  {
+    Put(s, static_cast<size_t>(n));
+    return n;
+  }
+
+  int sync ()
+  {
+    Flush();
+    return 0;
+  }
+
+ private:
+  static const size_t Capacity = 1 << 16;
+
+  int    fd_;
+  size_t n_;
+  char   b_[Capacity];
+
+  void Drain (const char* s, size_t n)
+  // write(2) until all n bytes are out: it may take only part of them
+  // (a pipe, a terminal) or be interrupted by a signal before any
+  {
+    while (n > 0)
+    {
+      ssize_t w = ::write(fd_, s, n);
+      if (w < 0 && errno == EINTR) continue;
+      if (w <= 0) return;
+      s += w;
+      n -= static_cast<size_t>(w);
+    }
+  }
+
+  Writer(const Writer&);
+  Writer& operator = (const Writer&);
+ };
+} // namespace pqio
+
+#endif
@@ -0,0 +1,539 @@
+/*
+  pqjournal.h
+
+  pqj::JournalQueue < Q >
+
+  Durability for any PriorityQueue in pq.h by write-ahead journaling with
+  group commit. JournalQueue < Q > derives from the queue Q, as
+  pql::LatencyQueue does, and appends a record of every change to a log
+  file: Push, Pop, Clear and Merge, and PopMin (pq5, pq16, pq17), Erase
+  (pq18) and TryPush (pq12) where Q has them. Everything else is Q's own.
+
+    pqj::JournalQueue < pq6::PriorityQueue < Job , JobLess > > q;
+    if (!q.Open("jobs.log", 4096)) ...   // recovers what the log holds
+    q.Push(job); q.Pop(); ...            // journaled in memory
+    q.Commit();                          // write + fdatasync: durable now
+    q.Checkpoint();                      // log := the current contents
+
+  Group commit: records collect in a buffer, and every "batch" records,
+  or on Commit, the buffer is written and made durable with one
+  fdatasync. The cost of a disk flush is shared by the whole batch, so a
+  batch of thousands keeps millions of operations per second durable; an
+  operation is durable once the commit after it returns, and a crash
+  loses the operations of the batch under way. SetDelay(d) also commits
+  when an operation finds the oldest waiting record d old: it is checked
+  only as operations are journaled, so an idle queue does not commit by
+  itself; call Commit() from a timer to bound the time a record waits.
+
+  A failed commit (a write or fdatasync error) is cut off the log, its
+  records stay in the buffer for the next commit to retry, and Good()
+  turns false until the next Open or a successful Checkpoint.
+
+  Records: '+' and a T for Push, '-' and the T popped for Pop, 'c' for
+  Clear; a Merge is a '+' per element taken from the other queue, PopMin
+  and Erase a '-'. A batch on disk is its length, its records and a checksum, so a
+  batch torn by a crash is found on recovery and cut off. Recovery
+  (Open) reads the log once: the elements pushed since the last Clear,
+  less those popped, sorted with P and pushed into Q largest first, which
+  for the binary heaps is a heap already, built in O(n) (smallest first
+  for pq5, whose sorted vector appends then). Popped elements are matched
+  to pushed ones within each run equal under P, by their bytes after
+  sorting the run by its bytes, so recovery is O(n log n); a popped
+  element whose bytes match no pushed one (padding) is matched by
+  operator==, so T needs one.
+
+  Checkpoint() rewrites the log as one batch of the current contents:
+  written to path.tmp, flushed, and renamed over path, so a crash leaves
+  either the old log or the new one. Recovery time then depends on Size()
+  and not on the history.
+
+  T must be trivially copyable: it is journaled as bytes.
+*/
+
+#ifndef _PQJOURNAL_H
+#define _PQJOURNAL_H
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>    // std::sort()
+#include <utility>      // std::declval()
+#include <chrono>
+#include <type_traits>  // std::decay<>, std::is_trivially_copyable<>
+#include <fcntl.h>      // open()
+#include <unistd.h>     // write(), read(), fdatasync(), ftruncate(), close()
+#include <stdio.h>      // rename()
+#include <pq.h>
+#include <pqdurable.h>  // pqd::Checksum()
+
+namespace pqj
+{
+ // the order in which recovery pushes the sorted elements into Q: largest
+ // first, except where that costs O(n) per push
+ template <class Q> struct LoadAscending { static const bool value = false; };
+ template <typename T, class P, class C>
+ struct LoadAscending < pq5::PriorityQueue < T , P , C > > { static const bool value = true; };
+
+ template <class> struct Void { typedef void Type; };
+
+ // the order of Q's elements, for recovery: by the predicate, or for the
+ // key-based queues (pq7, pq8) by the key, or where Q has both (pq11) by
+ // the predicate on the keys
+ template <class Q, typename T, class = void>
+ class ByPredicate
+ {
+  typename std::decay < decltype(std::declval<const Q&>().GetPredicate()) > ::type p_;
+ public:
+  explicit ByPredicate(const Q& q) : p_(q.GetPredicate()) {}
+  bool operator () (const T& a, const T& b) const { return p_(a, b); }
+ };
+
+ template <class Q, typename T>
+ class ByPredicate < Q , T , typename Void < decltype(std::declval<const Q&>().GetKey()) > ::Type >
+ {
+  typename std::decay < decltype(std::declval<const Q&>().GetKey()) > ::type       k_;
+  typename std::decay < decltype(std::declval<const Q&>().GetPredicate()) > ::type p_;
+ public:
+  explicit ByPredicate(const Q& q) : k_(q.GetKey()), p_(q.GetPredicate()) {}
+  bool operator () (const T& a, const T& b) const { return p_(k_(a), k_(b)); }
+ };
+
+ template <class Q, typename T, class = void>
+ class Order
+ {
+  typename std::decay < decltype(std::declval<const Q&>().GetKey()) > ::type k_;
+ public:
+  explicit Order(const Q& q) : k_(q.GetKey()) {}
+  bool operator () (const T& a, const T& b) const { return k_(a) < k_(b); }
+ };
+
+ template <class Q, typename T>
+ class Order < Q , T , typename Void < decltype(std::declval<const Q&>().GetPredicate()) > ::Type >
+   : public ByPredicate < Q , T >
+ {
+ public:
+  explicit Order(const Q& q) : ByPredicate < Q , T > (q) {}
+ };
+
+ template <class Q>
+ class JournalQueue : public Q
+ {
+ public:
+  typedef typename std::decay < decltype(std::declval<const Q&>().Front()) > ::type ValueType;
+
+ private:
+  typedef ValueType T;
+  static_assert(std::is_trivially_copyable<T>::value,
+                "pqj::JournalQueue: T is journaled as bytes");
+
+  // file: magic (8 bytes), sizeof(T) (8 bytes), then batches of
+  //   count (8 bytes), count records of 1 + sizeof(T) bytes ('c': T unused),
+  //   checksum of count and records (8 bytes)
+
+  static const unsigned long long Magic = 0x314A5150ULL;   // "PQJ1"
+  static const size_t             Rec   = 1 + sizeof(T);
+
+  std::string         path_;
+  int                 fd_;
+  std::vector<char>   buf_;          // count, then the records of the batch under way
+  size_t              count_;
+  size_t              batch_;
+  std::chrono::steady_clock::duration   delay_;
+  std::chrono::steady_clock::time_point first_;   // of the batch under way
+  unsigned long long  records_, commits_, bytes_;
+  bool                failed_;       // a commit failed since Open
+
+  // logs, on the way out of Merge, the elements Q::Merge took from other
+  class Taken
+  {
+   public:
+    Taken(JournalQueue& q, const Q& other) : q_(q), other_(other), copy_(other)
+    {}
+
+    ~Taken()
+    {
+      for (size_t n = copy_.Size() - other_.Size(); n > 0; --n, copy_.Pop())
+        q_.Log('+', copy_.Front());
+    }
+
+   private:
+    JournalQueue& q_;
+    const Q&      other_;
+    Q             copy_;
+  };
+
+ public:
+  JournalQueue() : Q(), fd_(-1), count_(0), batch_(1024), delay_(0),
+                   records_(0), commits_(0), bytes_(0), failed_(false)
+  {}
+
+  template <class A>
+  explicit JournalQueue(A a) : Q(a), fd_(-1), count_(0), batch_(1024), delay_(0),
+                               records_(0), commits_(0), bytes_(0), failed_(false)
+  {}
+
+  ~JournalQueue()
+  {
+    Close();
+  }
+
+  bool Open (const char* path, size_t batch = 1024)
+  // recover the queue from path (made empty if missing) and journal to it;
+  // false if it cannot be opened or was written for another sizeof(T)
+  {
+    Close();
+    path_  = path;
+    batch_ = batch > 0 ? batch : 1;
+    failed_ = false;
+    fd_ = ::open(path, O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (fd_ < 0) return false;
+    if (!Recover())
+    {
+      ::close(fd_);
+      fd_ = -1;
+      return false;
+    }
+    Reset();
+    return true;
+  }
+
+  void Close ()
+  // commit, then stop journaling; the queue keeps its contents
+  {
+    if (fd_ < 0) return;
+    Commit();
+    ::close(fd_);
+    fd_ = -1;
+  }
+
+  void SetBatch (size_t batch)
+  {
+    batch_ = batch > 0 ? batch : 1;
+  }
+
+  void SetDelay (std::chrono::microseconds delay)
+  // also commit when an operation finds the oldest record waiting this
+  // old (0: never); an idle queue is not committed by it
+  {
+    delay_ = delay;
+  }
+
+  bool Good () const
+  // open, and no commit has failed since Open or the last Checkpoint
+  {
+    return fd_ >= 0 && !failed_;
+  }
+
+  void Push (const T& t)
+  {
+    Q::Push(t);
+    Log('+', t);
+  }
+
+  void Pop ()
+  {
+    T t = Q::Front();
+    Q::Pop();
+    Log('-', t);
+  }
+
+  void Clear ()
+  {
+    Q::Clear();
+    Log('c', T());
+  }
+
+  auto Merge (Q&& other) -> decltype(std::declval<Q&>().Merge(static_cast<Q&&>(other)))
+  // journaled as a Push of every element taken from other (all of them,
+  // but for pq12, which takes only what fits)
+  {
+    Taken taken(*this, other);
+    return Q::Merge(static_cast<Q&&>(other));
+  }
+
+  template <class R = Q>
+  auto PopMin () -> decltype(std::declval<R&>().PopMin())
+  {
+    T t = Q::FrontMin();
+    Q::PopMin();
+    Log('-', t);
+  }
+
+  template <class R = Q>
+  auto Erase (const T& t) -> decltype(std::declval<R&>().Erase(t))
+  {
+    if (!Q::Erase(t)) return false;
+    Log('-', t);
+    return true;
+  }
+
+  template <class R = Q>
+  auto TryPush (const T& t) -> decltype(std::declval<R&>().TryPush(t))
+  {
+    if (!Q::TryPush(t)) return false;
+    Log('+', t);
+    return true;
+  }
+
+  bool Commit ()
+  // write the batch under way and fdatasync it; false on an I/O error,
+  // and the batch stays pending
+  {
+    if (fd_ < 0 || count_ == 0) return fd_ >= 0;
+    unsigned long long n = count_;
+    std::memcpy(&buf_[0], &n, sizeof(n));
+    unsigned long long sum = pqd::Checksum(&buf_[0], buf_.size());
+    buf_.insert(buf_.end(), reinterpret_cast<char*>(&sum), reinterpret_cast<char*>(&sum) + sizeof(sum));
+    bool ok = Write(fd_, &buf_[0], buf_.size()) && ::fdatasync(fd_) == 0;
+    ++commits_;
+    if (!ok)
+    {
+      Truncate(fd_, bytes_);                   // else cut off on recovery
+      buf_.resize(buf_.size() - sizeof(sum));
+      failed_ = true;
+      return false;
+    }
+    bytes_ += buf_.size();
+    Reset();
+    return true;
+  }
+
+  bool Checkpoint ()
+  // replace the log by one batch of the current contents
+  {
+    if (fd_ < 0 || !Commit()) return false;
+    std::string tmp = path_ + ".tmp";
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+
+    std::vector<char> b;
+    Append(b, Magic);
+    Append(b, sizeof(T));
+    if (!Q::Empty())
+    {
+      Q copy(static_cast<const Q&>(*this));
+      size_t start = b.size();
+      Append(b, static_cast<unsigned long long>(copy.Size()));
+      for (; !copy.Empty(); copy.Pop())
+      {
+        b.push_back('+');
+        const T& t = copy.Front();
+        b.insert(b.end(), reinterpret_cast<const char*>(&t), reinterpret_cast<const char*>(&t) + sizeof(T));
+      }
+      Append(b, pqd::Checksum(&b[start], b.size() - start));
+    }
+
+    bool ok = Write(fd, &b[0], b.size()) && ::fdatasync(fd) == 0;
+    ::close(fd);
+    if (!ok || ::rename(tmp.c_str(), path_.c_str()) != 0)
+    {
+      ::unlink(tmp.c_str());
+      return false;
+    }
+    SyncDirectory();
+    ::close(fd_);
+    fd_ = ::open(path_.c_str(), O_RDWR | O_APPEND);
+    bytes_ = b.size();
+    failed_ = false;
+    return fd_ >= 0;
+  }
+
+  static bool Remove (const char* path)
+  {
+    return ::unlink(path) == 0;
+  }
+
+  unsigned long long Records   () const { return records_; }   // journaled since Open
+  unsigned long long Commits   () const { return commits_; }   // fdatasyncs since Open
+  unsigned long long LogBytes  () const { return bytes_; }     // size of the log file
+  size_t             Pending   () const { return count_; }     // records not yet durable
+
+ private:
+  JournalQueue(const JournalQueue&);               // one journal per file
+  JournalQueue& operator = (const JournalQueue&);
+
+  static void Append (std::vector<char>& b, unsigned long long v)
+  {
+    b.insert(b.end(), reinterpret_cast<char*>(&v), reinterpret_cast<char*>(&v) + sizeof(v));
+  }
+
+  static bool Truncate (int fd, size_t n)
+  {
+    return ::ftruncate(fd, static_cast<off_t>(n)) == 0;
+  }
+
+  static bool Write (int fd, const char* p, size_t n)
+  {
+    while (n > 0)
+    {
+      ssize_t w = ::write(fd, p, n);
+      if (w <= 0) return false;
+      p += w;
+      n -= static_cast<size_t>(w);
+    }
+    return true;
+  }
+
+  void SyncDirectory ()
+  // make the rename durable
+  {
+    size_t slash = path_.rfind('/');
+    std::string dir = slash == std::string::npos ? "." : path_.substr(0, slash + 1);
+    int fd = ::open(dir.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    ::fsync(fd);
+    ::close(fd);
+  }
+
+  void Reset ()
+  {
+    buf_.resize(sizeof(unsigned long long));         // room for the count
+    count_ = 0;
+  }
+
+  void Log (char op, const T& t)
+  {
+    if (fd_ < 0) return;
+    if (count_ == 0 && delay_.count() > 0)
+      first_ = std::chrono::steady_clock::now();
+    buf_.push_back(op);
+    buf_.insert(buf_.end(), reinterpret_cast<const char*>(&t), reinterpret_cast<const char*>(&t) + sizeof(T));
+    ++count_;
+    ++records_;
+    if (count_ >= batch_
+        || (delay_.count() > 0 && std::chrono::steady_clock::now() - first_ >= delay_))
+      Commit();
+  }
+
+  bool Recover ()
+  // read the log, rebuild Q, cut a torn last batch off
+  {
+    std::vector<char> f;
+    char chunk[65536];
+    ssize_t r;
+    while ((r = ::read(fd_, chunk, sizeof(chunk))) > 0)
+      f.insert(f.end(), chunk, chunk + r);
+    if (r < 0) return false;
+
+    const unsigned long long head[2] = { Magic, sizeof(T) };
+    if (f.size() < sizeof(head))
+    {
+      // new, or torn before its header: start empty
+      if (!Truncate(fd_, 0) || !Write(fd_, reinterpret_cast<const char*>(head), sizeof(head))
+          || ::fdatasync(fd_) != 0)
+        return false;
+      Q::Clear();
+      bytes_ = sizeof(head);
+      return true;
+    }
+    if (std::memcmp(&f[0], head, sizeof(head)) != 0) return false;
+
+    std::vector<T> pushed, popped;
+    size_t at = sizeof(head);
+    while (at + 2 * sizeof(unsigned long long) <= f.size())
+    {
+      unsigned long long n, sum;
+      std::memcpy(&n, &f[at], sizeof(n));
+      size_t end = at + sizeof(n) + n * Rec;
+      if (n == 0 || n > (f.size() - at) / Rec || end + sizeof(sum) > f.size()) break;
+      std::memcpy(&sum, &f[end], sizeof(sum));
+      if (pqd::Checksum(&f[at], end - at) != sum) break;
+      for (const char* p = &f[at + sizeof(n)]; p < &f[end]; p += Rec)
+      {
+        T t;
+        std::memcpy(static_cast<void*>(&t), p + 1, sizeof(T));
+        if      (*p == '+') pushed.push_back(t);
+        else if (*p == '-') popped.push_back(t);
+        else
+        {
+          pushed.clear();
+          popped.clear();
+        }
+      }
+      at = end + sizeof(sum);
+    }
+    if (at < f.size() && (!Truncate(fd_, at) || ::fdatasync(fd_) != 0))
+      return false;
+    bytes_ = at;
+    Load(pushed, popped);
+    return true;
+  }
+
+  static bool Bytes (const T& a, const T& b)
+  {
+    return std::memcmp(&a, &b, sizeof(T)) < 0;
+  }
+
+  static void Match (std::vector<T>& pushed, size_t i, size_t ie,
+                     std::vector<T>& popped, size_t j, size_t je, std::vector<T>& keep)
+  // keep pushed[i, ie) less popped[j, je), a run equal under P: both
+  // sorted by their bytes and walked in step, then operator== for what
+  // bytes did not match (padding)
+  {
+    std::sort(pushed.begin() + i, pushed.begin() + ie, Bytes);
+    std::sort(popped.begin() + j, popped.begin() + je, Bytes);
+    size_t from = keep.size();
+    std::vector<T> rest;                       // popped, bytes unmatched
+    while (i < ie && j < je)
+    {
+      int c = std::memcmp(&pushed[i], &popped[j], sizeof(T));
+      if      (c < 0) keep.push_back(pushed[i++]);
+      else if (c > 0) rest.push_back(popped[j++]);
+      else            { ++i; ++j; }
+    }
+    keep.insert(keep.end(), pushed.begin() + i, pushed.begin() + ie);
+    rest.insert(rest.end(), popped.begin() + j, popped.begin() + je);
+    for (size_t r = 0; r < rest.size(); ++r)
+      for (size_t k = from; k < keep.size(); ++k)
+        if (keep[k] == rest[r])
+        {
+          keep[k] = keep.back();
+          keep.pop_back();
+          break;
+        }
+  }
+
+  void Load (std::vector<T>& pushed, std::vector<T>& popped)
+  // Q := pushed less popped, by bulk insertion in sorted order
+  {
+    Order < Q , T > less(*this);
+    auto descending = [&less](const T& a, const T& b) { return less(b, a); };
+    std::sort(pushed.begin(), pushed.end(), descending);
+    std::sort(popped.begin(), popped.end(), descending);
+
+    // walk both in step; within a run of elements equal under P, match
+    // each popped element to an equal pushed one (Match)
+    std::vector<T> keep;
+    keep.reserve(pushed.size() >= popped.size() ? pushed.size() - popped.size() : 0);
+    size_t i = 0, j = 0;
+    while (i < pushed.size())
+    {
+      if (j == popped.size() || descending(pushed[i], popped[j]))
+      {
+        keep.push_back(pushed[i++]);
+        continue;
+      }
+      if (descending(popped[j], pushed[i]))        // popped, never pushed
+      {
+        ++j;
+        continue;
+      }
+      size_t ie = i, je = j;
+      while (ie < pushed.size() && !descending(pushed[i], pushed[ie])) ++ie;
+      while (je < popped.size() && !descending(popped[j], popped[je])) ++je;
+      Match(pushed, i, ie, popped, j, je, keep);
+      i = ie;
+      j = je;
+    }
+
+    Q::Clear();
+    if (LoadAscending<Q>::value)
+      for (size_t k = keep.size(); k-- > 0; ) Q::Push(keep[k]);
+    else
+      for (size_t k = 0; k < keep.size(); ++k) Q::Push(keep[k]);
+  }
+ };
+} // namespace pqj
+
+#endif
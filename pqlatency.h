@@ -0,0 +1,294 @@
+/*
+  pqlatency.h
+
+  pql::Histogram, pql::LatencyQueue < Q , C >
+
+  Opt-in per-operation latency recording for any PriorityQueue in pq.h.
+  LatencyQueue < Q > derives from the queue Q and times every Push, Pop
+  and Front with the clock C into one Histogram per operation; everything
+  else is Q's own. Averages hide the rare O(n) operations (a Vector
+  reallocation in pq6, a long MOVector shift in pq5); the tail of the
+  histogram shows them.
+
+  Histogram is log-linear, in the manner of an HDR histogram: values
+  below 2^S are counted exactly, and every power-of-2 range above is cut
+  into 2^S equal sub-buckets, so any recorded value is known to within
+  1/2^S (about 3% for S = 5) over the whole 64-bit range, in a fixed
+  array of (65 - S) * 2^S counters. Recording is a count-leading-zeros,
+  a shift and an increment.
+
+  Clocks count ticks; NsPerTick() converts them for reporting.
+    TscClock     the time stamp counter (x86 only), calibrated once
+                 against steady_clock the first time NsPerTick() is called
+    SteadyClock  std::chrono::steady_clock, in ns
+  DefaultClock is TscClock where there is one; the two time stamps and
+  the record cost on the order of 10 ns per operation.
+
+    pql::LatencyQueue < pq6::PriorityQueue < T , P > > q;
+    ... q.Push(t) ... q.Pop() ...
+    q.Report(std::cout);                     // p50 p99 p99.9 max per op
+    q.PushLatency().Dump(std::cout);         // the whole histogram
+
+  pqp::Timed < Policy >, defined here, applies the wrapper to a policy of
+  pqp::PriorityQueue (pqpolicy.h).
+*/
+
+#ifndef _PQLATENCY_H
+#define _PQLATENCY_H
+
+#include <cstddef>
+#include <utility>     // std::declval()
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>  // __rdtsc()
+#endif
+
+namespace pql
+{
+ typedef unsigned long long Tick;
+
+ class SteadyClock
+ {
+ public:
+  static Tick Now ()
+  {
+    return static_cast<Tick>(std::chrono::duration_cast<std::chrono::nanoseconds>
+                             (std::chrono::steady_clock::now().time_since_epoch()).count());
+  }
+
+  static double NsPerTick ()
+  {
+    return 1.0;
+  }
+ };
+
+#if defined(__x86_64__) || defined(__i386__)
+ class TscClock
+ {
+ public:
+  static Tick Now ()
+  {
+    return __rdtsc();
+  }
+
+  static double NsPerTick ()
+  // measured once over about 20 ms
+  {
+    static const double r = Calibrate();
+    return r;
+  }
+
+ private:
+  static double Calibrate ()
+  {
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    Tick c0 = Now();
+    std::chrono::steady_clock::time_point t1;
+    do t1 = std::chrono::steady_clock::now();
+    while (t1 - t0 < std::chrono::milliseconds(20));
+    Tick c1 = Now();
+    std::chrono::duration<double, std::nano> ns = t1 - t0;
+    return c1 > c0 ? ns.count() / (c1 - c0) : 1.0;
+  }
+ };
+
+ typedef TscClock DefaultClock;
+#else
+ typedef SteadyClock DefaultClock;
+#endif
+
+ template <size_t S = 5>
+ class Histogram
+ {
+ public:
+  static const size_t Sub     = size_t(1) << S;        // sub-buckets per power of 2
+  static const size_t Buckets = (65 - S) * Sub;
+
+  Histogram()
+  {
+    Clear();
+  }
+
+  void Record (Tick v)
+  {
+    ++count_[Index(v)];
+    ++n_;
+    sum_ += v;
+    if (v > max_) max_ = v;
+    if (v < min_) min_ = v;
+  }
+
+  void Clear ()
+  {
+    for (size_t i = 0; i < Buckets; ++i) count_[i] = 0;
+    n_ = 0;
+    sum_ = 0;
+    max_ = 0;
+    min_ = ~Tick(0);
+  }
+
+  void Merge (const Histogram& h)
+  // add the values recorded in h, as if they had been recorded here
+  {
+    for (size_t i = 0; i < Buckets; ++i) count_[i] += h.count_[i];
+    n_ += h.n_;
+    sum_ += h.sum_;
+    if (h.max_ > max_) max_ = h.max_;
+    if (h.min_ < min_) min_ = h.min_;
+  }
+
+  unsigned long long Count () const { return n_; }
+  Tick               Max   () const { return max_; }
+  Tick               Min   () const { return n_ > 0 ? min_ : 0; }
+  double             Mean  () const { return n_ > 0 ? static_cast<double>(sum_) / n_ : 0.0; }
+
+  Tick Percentile (double q) const
+  // smallest bucket value with at least q percent of the values at or
+  // below it (highest value of that bucket, at most Max())
+  {
+    if (n_ == 0) return 0;
+    unsigned long long rank = static_cast<unsigned long long>(q / 100.0 * n_ + 0.5);
+    if (rank < 1)  rank = 1;
+    if (rank > n_) rank = n_;
+    unsigned long long seen = 0;
+    for (size_t i = 0; i < Buckets; ++i)
+    {
+      seen += count_[i];
+      if (seen >= rank)
+        return High(i) < max_ ? High(i) : max_;
+    }
+    return max_;
+  }
+
+  void Summary (std::ostream& os, double nsPerTick = 1.0) const
+  // one line: count, mean, p50, p99, p99.9, max in ns
+  {
+    os << std::fixed << std::setprecision(1)
+       << "n " << n_
+       << "  mean "  << Mean() * nsPerTick
+       << "  p50 "   << Percentile(50.0)  * nsPerTick
+       << "  p99 "   << Percentile(99.0)  * nsPerTick
+       << "  p99.9 " << Percentile(99.9)  * nsPerTick
+       << "  max "   << Max() * nsPerTick << "  (ns)\n";
+  }
+
+  void Dump (std::ostream& os, double nsPerTick = 1.0) const
+  // one line per non-empty bucket: upper value (ns), count, cumulative %
+  {
+    os << "     value (ns)         count   cumulative\n";
+    unsigned long long seen = 0;
+    for (size_t i = 0; i < Buckets; ++i)
+    {
+      if (count_[i] == 0) continue;
+      seen += count_[i];
+      os << std::fixed << std::setprecision(1)
+         << std::setw(15) << High(i) * nsPerTick
+         << std::setw(14) << count_[i]
+         << std::setprecision(4) << std::setw(12) << 100.0 * seen / n_ << "%\n";
+    }
+  }
+
+ private:
+  unsigned long long count_[Buckets];
+  unsigned long long n_;
+  Tick               sum_, max_, min_;
+
+  static size_t Index (Tick v)
+  {
+    if (v < Sub) return static_cast<size_t>(v);
+    size_t e = 63 - __builtin_clzll(v);                  // 2^e <= v < 2^(e+1), e >= S
+    return ((e - S + 1) << S) + static_cast<size_t>((v >> (e - S)) - Sub);
+  }
+
+  static Tick High (size_t i)
+  // largest value counted in bucket i
+  {
+    if (i < Sub) return i;
+    size_t b = i >> S;
+    Tick m = Sub + (i & (Sub - 1));
+    return ((m + 1) << (b - 1)) - 1;
+  }
+ };
+
+ template <class Q, class C = DefaultClock>
+ class LatencyQueue : public Q
+ {
+ public:
+  typedef Histogram < > HistogramType;
+
+  LatencyQueue() : Q()
+  {}
+
+  template <class A>
+  explicit LatencyQueue(A a) : Q(a)
+  {}
+
+  template <typename T>
+  void Push (const T& t)
+  {
+    Tick s = C::Now();
+    Q::Push(t);
+    push_.Record(C::Now() - s);
+  }
+
+  void Pop ()
+  {
+    Tick s = C::Now();
+    Q::Pop();
+    pop_.Record(C::Now() - s);
+  }
+
+  auto Front () const -> decltype(std::declval<const Q&>().Front())
+  {
+    Tick s = C::Now();
+    auto& f = Q::Front();
+    front_.Record(C::Now() - s);
+    return f;
+  }
+
+  const HistogramType& PushLatency  () const { return push_; }
+  const HistogramType& PopLatency   () const { return pop_; }
+  const HistogramType& FrontLatency () const { return front_; }
+
+  void ClearLatency ()
+  {
+    push_.Clear();
+    pop_.Clear();
+    front_.Clear();
+  }
+
+  void Report (std::ostream& os) const
+  {
+    double r = C::NsPerTick();
+    os << "  Push : "; push_.Summary(os, r);
+    os << "  Pop  : "; pop_.Summary(os, r);
+    os << "  Front: "; front_.Summary(os, r);
+  }
+
+ private:
+  HistogramType         push_, pop_;
+  mutable HistogramType front_;
+ };
+} // namespace pql
+
+namespace pqp
+{
+ template <class Policy>
+ struct Timed
+ {
+  template <typename T, class P> struct Apply
+  {
+    typedef pql::LatencyQueue < typename Policy::template Apply < T , P > ::Type > Type;
+  };
+  static const char* Name ()
+  {
+    static const std::string name = std::string(Policy::Name()) + ", timed";
+    return name.c_str();
+  }
+ };
+} // namespace pqp
+
+#endif
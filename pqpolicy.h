@@ -0,0 +1,212 @@
+/*
+  pqpolicy.h
+
+  pqp::PriorityQueue < T , P , Policy >
+
+  One PriorityQueue template for all of the implementations in pq.h. The
+  implementation is chosen at compile time by the Policy argument, and
+  pqp::PriorityQueue simply derives from the chosen class: every call is
+  resolved statically, there are no virtual functions and no extra data.
+
+  policy                 nmsp  implementation
+  ------                 ----  --------------
+  UnorderedList          pq1   List, g_max_element()
+  SortedList             pq2   MOList, Insert()
+  DequeSwap              pq3   Deque, g_max_element(), XC
+  DequeLeapfrog          pq4   Deque, g_max_element(), Leapfrog
+  SortedVector           pq5   MOVector, Insert()
+  Heap                   pq6   Vector, hole sifts, bottom-up pop
+  Bucket < K , N >       pq7   Deque[N], bitmap + clz
+  Calendar < K >         pq8   calendar queue
+  SequenceHeap < M , K > pq9   sequence heap
+  DaryHeap < D >         pq10  D-ary heap
+  KeySlot < K , KP >     pq11  (key,slot) heap + slots
+  Static < N >           pq12  inline array heap
+  Adaptive               pq13  sorted vector <-> heap
+  WeakHeap               pq14  weak heap
+  Persistent             pq15  persistent leftist heap
+  Interval               pq16  interval heap (double-ended)
+  MinMax                 pq17  min-max heap (double-ended)
+  IntTrie                pq18  bit trie, integer keys of 32 bits
+  BHeap < B >            pq19  B-heap, pages of B bytes
+
+  in hugevec.h (mmap, mbind):
+  HugeHeap < F >         pq6   as Heap, in pqh::Vector: huge pages,
+                               NUMA-local with F = pqh::Local
+  HugeSortedVector < F > pq5   as SortedVector, in pqh::MOVector
+  HugeBHeap < B , F >    pq19  as BHeap, in pqh::Vector
+
+  in pqlatency.h (clocks):
+  Timed < Policy >       any   Policy, with per-operation latency
+                               histograms (pql::LatencyQueue)
+
+  Those two headers are not included here, so a program that uses neither
+  does not depend on them; include them for their policies.
+
+  The key-based policies (Bucket, Calendar, KeySlot) order elements by
+  their key function K and ignore P; construct them with a K object, or
+  default-construct them.
+
+  A policy is a class with a nested template Apply < T , P > naming the
+  implementation type, and a static Name(). Client code picks a policy
+  with a typedef, or with the macro PQ_POLICY (see fpq.cpp), so that a
+  makefile or a generated header can choose the implementation without
+  editing source:
+
+    typedef pqp::PriorityQueue < Widget , PredicateType , pqp::Heap > PriorityQueue;
+
+    clang++ -DPQ_POLICY=pqp::SortedVector ... fpq.cpp
+*/
+
+#ifndef _PQPOLICY_H
+#define _PQPOLICY_H
+
+#include <pq.h>
+
+namespace pqp
+{
+ struct UnorderedList
+ {
+  template <typename T, class P> struct Apply { typedef pq1::PriorityQueue < T , P > Type; };
+  static const char* Name () { return "List, g_max_element()"; }
+ };
+
+ struct SortedList
+ {
+  template <typename T, class P> struct Apply { typedef pq2::PriorityQueue < T , P > Type; };
+  static const char* Name () { return "MOList, Insert()"; }
+ };
+
+ struct DequeSwap
+ {
+  template <typename T, class P> struct Apply { typedef pq3::PriorityQueue < T , P > Type; };
+  static const char* Name () { return "Deque, g_max_element(), XC"; }
+ };
+
+ struct DequeLeapfrog
+ {
+  template <typename T, class P> struct Apply { typedef pq4::PriorityQueue < T , P > Type; };
+  static const char* Name () { return "Deque, g_max_element(), Leapfrog"; }
+ };
+
+ struct SortedVector
+ {
+  template <typename T, class P> struct Apply { typedef pq5::PriorityQueue < T , P > Type; };
+  static const char* Name () { return "MOVector, Insert()"; }
+ };
+
+ struct Heap
+ {
+  template <typename T, class P> struct Apply { typedef pq6::PriorityQueue < T , P > Type; };
+  static const char* Name () { return "Vector, hole sifts, bottom-up pop"; }
+ };
+
+ template <class K, size_t N = 256>
+ struct Bucket
+ {
+  template <typename T, class P> struct Apply { typedef pq7::PriorityQueue < T , K , N > Type; };
+  static const char* Name () { return "Deque[N], bitmap + clz"; }
+ };
+
+ template <class K>
+ struct Calendar
+ {
+  template <typename T, class P> struct Apply { typedef pq8::PriorityQueue < T , K > Type; };
+  static const char* Name () { return "calendar queue"; }
+ };
+
+ template <size_t M = 256, size_t K = 64>
+ struct SequenceHeap
+ {
+  template <typename T, class P> struct Apply { typedef pq9::PriorityQueue < T , P , M , K > Type; };
+  static const char* Name () { return "sequence heap"; }
+ };
+
+ template <size_t D = 4>
+ struct DaryHeap
+ {
+  template <typename T, class P> struct Apply { typedef pq10::PriorityQueue < T , P , D > Type; };
+  static const char* Name () { return "D-ary heap"; }
+ };
+
+ template <class K, class KP>
+ struct KeySlot
+ {
+  template <typename T, class P> struct Apply { typedef pq11::PriorityQueue < T , K , KP > Type; };
+  static const char* Name () { return "(key,slot) heap + slots"; }
+ };
+
+ template <size_t N>
+ struct Static
+ {
+  template <typename T, class P> struct Apply { typedef pq12::StaticPriorityQueue < T , P , N > Type; };
+  static const char* Name () { return "inline array heap"; }
+ };
+
+ struct Adaptive
+ {
+  template <typename T, class P> struct Apply { typedef pq13::PriorityQueue < T , P > Type; };
+  static const char* Name () { return "sorted vector <-> heap"; }
+ };
+
+ struct WeakHeap
+ {
+  template <typename T, class P> struct Apply { typedef pq14::PriorityQueue < T , P > Type; };
+  static const char* Name () { return "weak heap"; }
+ };
+
+ struct Persistent
+ {
+  template <typename T, class P> struct Apply { typedef pq15::PriorityQueue < T , P > Type; };
+  static const char* Name () { return "persistent leftist heap"; }
+ };
+
+ struct Interval
+ {
+  template <typename T, class P> struct Apply { typedef pq16::PriorityQueue < T , P > Type; };
+  static const char* Name () { return "interval heap"; }
+ };
+
+ struct MinMax
+ {
+  template <typename T, class P> struct Apply { typedef pq17::PriorityQueue < T , P > Type; };
+  static const char* Name () { return "min-max heap"; }
+ };
+
+ struct IntTrie
+ {
+  template <typename T, class P> struct Apply { typedef pq18::PriorityQueue < T , P > Type; };
+  static const char* Name () { return "bit trie, 32-bit keys"; }
+ };
+
+ template <size_t B = 4096>
+ struct BHeap
+ {
+  template <typename T, class P> struct Apply { typedef pq19::PriorityQueue < T , P , B > Type; };
+  static const char* Name () { return "B-heap"; }
+ };
+
+ template <typename T, class P, class Policy = Heap>
+ class PriorityQueue : public Policy::template Apply < T , P > ::Type
+ {
+  typedef typename Policy::template Apply < T , P > ::Type BaseType;
+
+ public:
+  typedef Policy PolicyType;
+
+  PriorityQueue() : BaseType()
+  {}
+
+  // P for the comparison policies, K for the key-based ones
+  template <class A>
+  explicit PriorityQueue(A a) : BaseType(a)
+  {}
+
+  static const char* Implementation ()
+  {
+    return Policy::Name();
+  }
+ };
+} // namespace pqp
+
+#endif
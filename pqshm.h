@@ -0,0 +1,407 @@
+/*
+  pqshm.h
+
+  pqs::SharedQueue < T , P >
+
+  A priority queue in a POSIX shared-memory segment, for processes on one
+  machine that push to and pop from the same queue without a broker in
+  between. One process creates the segment by name, the others open it:
+
+    pqs::SharedQueue < Job , JobLess > q;
+    q.Create("/jobs", 100000);         // or q.Open("/jobs") in the others
+    q.Push(job);                       // waits while the queue is full
+    while (q.Pop(job)) ...             // waits while it is empty
+    q.Shutdown();                      // wakes the waiting Pops: they drain
+                                       // the queue, then return false
+    pqs::SharedQueue < Job , JobLess > ::Unlink("/jobs");
+
+  The segment holds a header (sizes, a process-shared mutex and two
+  condition variables) followed by an implicit binary heap of at most
+  capacity elements, as in pq6 (hole-based sift up, bottom-up Pop). It
+  contains no pointers, only sizes and indices, so every process may map
+  it at a different address. T must therefore be trivially copyable (no
+  std::string: a fixed char array instead), and P is constructed in each
+  process, so it must not carry state. The capacity is fixed at Create:
+  a segment that other processes have mapped cannot grow.
+
+  Because another process may pop between the two calls, there is no
+  Front() + Pop() pair: Pop(t) and TryPop(t) copy the front out and
+  remove it under one lock; Front(t) only copies it.
+
+  The mutex is robust: when a process dies holding it, the next locker
+  gets it back, and rebuilds the heap, since the dead one may have been
+  in the middle of a sift (at most the one element it was moving is lost
+  or doubled).
+
+  Link with -pthread (and -lrt on older glibc, for shm_open).
+*/
+
+#ifndef _PQSHM_H
+#define _PQSHM_H
+
+#include <cstddef>
+#include <cstring>
+#include <cerrno>
+#include <iostream>
+#include <type_traits>  // std::is_trivially_copyable<>
+#include <pthread.h>
+#include <fcntl.h>      // O_CREAT, O_EXCL, O_RDWR
+#include <unistd.h>     // ftruncate(), close(), usleep()
+#include <sys/mman.h>   // shm_open(), shm_unlink(), mmap(), munmap()
+#include <sys/stat.h>   // fstat()
+
+namespace pqs
+{
+ template <typename T, class P>
+ class SharedQueue
+ {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "pqs::SharedQueue: T is copied between processes as bytes");
+
+  // Create(name, capacity)   : new segment with room for capacity elements
+  // Open(name)               : map an existing segment
+  // Push(t), TryPush(t)      : sift up in the shared array, under the mutex
+  // Pop(t), TryPop(t)        : copy out v[0], bottom-up sift of the last leaf
+  // Shutdown()               : no more Pushes; Pops drain, then return false
+  // Close()                  : unmap (the segment stays until Unlink)
+
+  struct Header
+  {
+    unsigned long long magic_;
+    unsigned long long element_;       // sizeof(T) of the creator
+    unsigned long long capacity_;
+    unsigned long long size_;
+    unsigned long long pushes_;
+    unsigned long long pops_;
+    int                shutdown_;
+    int                ready_;         // set last by Create
+    pthread_mutex_t    mutex_;
+    pthread_cond_t     nonempty_;
+    pthread_cond_t     nonfull_;
+  };
+
+  static const unsigned long long Magic = 0x31535150ULL;   // "PQS1"
+
+  Header*  h_;
+  size_t   bytes_;
+  P        p_;
+
+ public:
+
+  typedef T ValueType;
+  typedef P PredicateType;
+
+  SharedQueue() : h_(0), bytes_(0), p_()
+  {}
+
+  ~SharedQueue()
+  {
+    Close();
+  }
+
+  bool Create (const char* name, size_t capacity)
+  // false if the segment exists or cannot be made
+  {
+    Close();
+    if (capacity == 0) return false;
+    int fd = ::shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) return false;
+    size_t bytes = Offset() + capacity * sizeof(T);
+    if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0 || !Map(fd, bytes))
+    {
+      ::close(fd);
+      ::shm_unlink(name);
+      return false;
+    }
+    ::close(fd);
+
+    h_->magic_    = Magic;
+    h_->element_  = sizeof(T);
+    h_->capacity_ = capacity;
+    h_->size_     = 0;
+    h_->pushes_   = 0;
+    h_->pops_     = 0;
+    h_->shutdown_ = 0;
+
+    pthread_mutexattr_t ma;
+    pthread_mutexattr_init(&ma);
+    pthread_mutexattr_setpshared(&ma, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&ma, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(&h_->mutex_, &ma);
+    pthread_mutexattr_destroy(&ma);
+
+    pthread_condattr_t ca;
+    pthread_condattr_init(&ca);
+    pthread_condattr_setpshared(&ca, PTHREAD_PROCESS_SHARED);
+    pthread_cond_init(&h_->nonempty_, &ca);
+    pthread_cond_init(&h_->nonfull_, &ca);
+    pthread_condattr_destroy(&ca);
+
+    __atomic_store_n(&h_->ready_, 1, __ATOMIC_RELEASE);
+    return true;
+  }
+
+  bool Open (const char* name)
+  // false if there is no such segment, or it holds another T
+  {
+    Close();
+    int fd = ::shm_open(name, O_RDWR, 0);
+    if (fd < 0) return false;
+    struct stat st;
+    bool ok = false;
+    // the creator may still be between ftruncate and the end of Create
+    for (int tries = 0; tries < 1000 && !ok; ++tries)
+    {
+      if (::fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= Offset())
+      {
+        if (h_ == 0 && !Map(fd, static_cast<size_t>(st.st_size))) break;
+        ok = __atomic_load_n(&h_->ready_, __ATOMIC_ACQUIRE) != 0;
+      }
+      if (!ok) ::usleep(1000);
+    }
+    ::close(fd);
+    if (!ok || h_->magic_ != Magic || h_->element_ != sizeof(T)
+        || bytes_ < Offset() + h_->capacity_ * sizeof(T))
+    {
+      Close();
+      return false;
+    }
+    return true;
+  }
+
+  void Close ()
+  {
+    if (h_ != 0) ::munmap(h_, bytes_);
+    h_ = 0;
+    bytes_ = 0;
+  }
+
+  static bool Unlink (const char* name)
+  {
+    return ::shm_unlink(name) == 0;
+  }
+
+  bool Good () const
+  {
+    return h_ != 0;
+  }
+
+  bool Push (const T& t)
+  // waits while full; false after Shutdown()
+  // O(log n)
+  {
+    Lock();
+    while (h_->size_ == h_->capacity_ && !h_->shutdown_)
+      Wait(&h_->nonfull_);
+    bool ok = !h_->shutdown_;
+    if (ok) Insert(t);
+    Unlock();
+    return ok;
+  }
+
+  bool TryPush (const T& t)
+  // false if full or after Shutdown()
+  // O(log n)
+  {
+    Lock();
+    bool ok = h_->size_ < h_->capacity_ && !h_->shutdown_;
+    if (ok) Insert(t);
+    Unlock();
+    return ok;
+  }
+
+  bool Pop (T& t)
+  // waits while empty; false once empty after Shutdown()
+  // O(log n)
+  {
+    Lock();
+    while (h_->size_ == 0 && !h_->shutdown_)
+      Wait(&h_->nonempty_);
+    bool ok = h_->size_ > 0;
+    if (ok) Remove(t);
+    Unlock();
+    return ok;
+  }
+
+  bool TryPop (T& t)
+  // false if empty
+  // O(log n)
+  {
+    Lock();
+    bool ok = h_->size_ > 0;
+    if (ok) Remove(t);
+    Unlock();
+    return ok;
+  }
+
+  bool Front (T& t)
+  // a copy of the front, which another process may pop at once
+  // O(1)
+  {
+    Lock();
+    bool ok = h_->size_ > 0;
+    if (ok) t = Array()[0];
+    Unlock();
+    return ok;
+  }
+
+  void Shutdown ()
+  {
+    Lock();
+    h_->shutdown_ = 1;
+    pthread_cond_broadcast(&h_->nonempty_);
+    pthread_cond_broadcast(&h_->nonfull_);
+    Unlock();
+  }
+
+  void Clear ()
+  {
+    Lock();
+    h_->size_ = 0;
+    pthread_cond_broadcast(&h_->nonfull_);
+    Unlock();
+  }
+
+  bool Empty () const
+  {
+    return Size() == 0;
+  }
+
+  size_t Size () const
+  {
+    return static_cast<size_t>(__atomic_load_n(&h_->size_, __ATOMIC_RELAXED));
+  }
+
+  size_t Capacity () const
+  {
+    return static_cast<size_t>(h_->capacity_);
+  }
+
+  unsigned long long Pushes () const { return h_->pushes_; }
+  unsigned long long Pops   () const { return h_->pops_; }
+
+  P GetPredicate() const
+  {
+    return p_;
+  }
+
+  void Dump (std::ostream& os, char ofc = '\0')
+  {
+    Lock();
+    const T* a = Array();
+    for (size_t i = 0; i < h_->size_; ++i)
+    {
+      os << a[i];
+      if (ofc != '\0') os << ofc;
+    }
+    Unlock();
+  }
+
+ private:
+  // the heap starts at the first cache line after the header
+  static size_t Offset ()
+  {
+    size_t align = alignof(T) > 64 ? alignof(T) : 64;
+    return (sizeof(Header) + align - 1) / align * align;
+  }
+
+  T* Array () const
+  {
+    return reinterpret_cast<T*>(reinterpret_cast<char*>(h_) + Offset());
+  }
+
+  bool Map (int fd, size_t bytes)
+  {
+    void* m = ::mmap(0, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (m == MAP_FAILED) return false;
+    h_ = static_cast<Header*>(m);
+    bytes_ = bytes;
+    return true;
+  }
+
+  void Lock ()
+  {
+    if (pthread_mutex_lock(&h_->mutex_) == EOWNERDEAD)
+      Recover();
+  }
+
+  void Unlock ()
+  {
+    pthread_mutex_unlock(&h_->mutex_);
+  }
+
+  void Wait (pthread_cond_t* c)
+  {
+    if (pthread_cond_wait(c, &h_->mutex_) == EOWNERDEAD)
+      Recover();
+  }
+
+  void Recover ()
+  // the previous owner died with the lock: restore heap order (Floyd)
+  {
+    size_t n = static_cast<size_t>(h_->size_);
+    T* a = Array();
+    for (size_t i = n / 2; i-- > 0; )
+    {
+      T t = a[i];
+      size_t x = i, c;
+      while ((c = 2 * x + 1) < n)
+      {
+        if (c + 1 < n && p_(a[c], a[c + 1])) ++c;
+        if (!p_(t, a[c])) break;
+        a[x] = a[c];
+        x = c;
+      }
+      a[x] = t;
+    }
+    pthread_mutex_consistent(&h_->mutex_);
+  }
+
+  void Insert (const T& t)
+  {
+    T* a = Array();
+    size_t x = static_cast<size_t>(h_->size_);
+    while (x > 0)
+    {
+      size_t parent = (x - 1) / 2;
+      if (!p_(a[parent], t)) break;
+      a[x] = a[parent];
+      x = parent;
+    }
+    a[x] = t;
+    __atomic_store_n(&h_->size_, h_->size_ + 1, __ATOMIC_RELAXED);
+    ++h_->pushes_;
+    pthread_cond_signal(&h_->nonempty_);
+  }
+
+  void Remove (T& t)
+  {
+    T* a = Array();
+    t = a[0];
+    size_t n = static_cast<size_t>(h_->size_) - 1;
+    // bottom-up: walk the hole to a leaf along larger children, then
+    // sift the last element up from there
+    size_t x = 0, c;
+    while ((c = 2 * x + 1) < n)
+    {
+      if (c + 1 < n && p_(a[c], a[c + 1])) ++c;
+      a[x] = a[c];
+      x = c;
+    }
+    T last = a[n];
+    while (x > 0)
+    {
+      size_t parent = (x - 1) / 2;
+      if (!p_(a[parent], last)) break;
+      a[x] = a[parent];
+      x = parent;
+    }
+    a[x] = last;
+    __atomic_store_n(&h_->size_, static_cast<unsigned long long>(n), __ATOMIC_RELAXED);
+    ++h_->pops_;
+    pthread_cond_signal(&h_->nonfull_);
+  }
+ };
+} // namespace pqs
+
+#endif
@@ -10,8 +10,61 @@
 
 #include <iostream>
 #include <fstream>
+#include <pair.h>
 #include <compare.h>
 #include <pq.h>
+#include <pqpolicy.h>
+
+template < class Policy >
+struct Queue
+{
+  typedef pqp::PriorityQueue < int , fsu::GreaterThan < int > , Policy > Type;
+};
+
+template < class Q >
+void Dump (const char* name, const Q& q)
+{
+  std::cout << name << ".Dump(): ";
+  q.Dump(std::cout, ' ');
+  std::cout << '\n';
+}
+
+template < class Q >
+void Drain (const char* name, Q& q)
+{
+  std::cout << name << " Output:";
+  while (!q.Empty())
+  {
+    std::cout << ' ' << q.Front();
+    q.Pop();
+  }
+  std::cout << '\n';
+}
+
+// pq5 PopMin followed by Pushes that tie the elements PopMin has taken:
+// records compare on priority only, so a lost or revived record shows in
+// the payloads. Expected:
+//   Q5 PopMin ties: 2:g 2:f 2:b 2:a 3:d 4:e
+void PopMinTies ()
+{
+  typedef fsu::Pair < int , char > Record;
+  pq5::PriorityQueue < Record , fsu::LessThan < Record > > q;
+  q.Push(Record(2,'a'));
+  q.Push(Record(2,'b'));
+  q.Push(Record(2,'c'));
+  q.Push(Record(3,'d'));
+  q.Push(Record(4,'e'));
+  q.PopMin();                  // 2:c
+  q.Push(Record(2,'f'));       // ties the slot PopMin left
+  q.Push(Record(2,'g'));
+  std::cout << "Q5 PopMin ties:";
+  while (!q.Empty())
+  {
+    std::cout << ' ' << q.FrontMin().first_ << ':' << q.FrontMin().second_;
+    q.PopMin();
+  }
+  std::cout << '\n';
+}
 
 int main(int argc, char* argv[])
 {
@@ -29,12 +82,12 @@ int main(int argc, char* argv[])
     exit (EXIT_SUCCESS);
   }
 
-  pq1::PriorityQueue < int , fsu::GreaterThan < int > > Q1;
-  pq2::PriorityQueue < int , fsu::GreaterThan < int > > Q2;
-  pq3::PriorityQueue < int , fsu::GreaterThan < int > > Q3;
-  pq4::PriorityQueue < int , fsu::GreaterThan < int > > Q4;
-  pq5::PriorityQueue < int , fsu::GreaterThan < int > > Q5;
-  pq6::PriorityQueue < int , fsu::GreaterThan < int > > Q6;
+  Queue < pqp::UnorderedList > ::Type Q1;
+  Queue < pqp::SortedList >    ::Type Q2;
+  Queue < pqp::DequeSwap >     ::Type Q3;
+  Queue < pqp::DequeLeapfrog > ::Type Q4;
+  Queue < pqp::SortedVector >  ::Type Q5;
+  Queue < pqp::Heap >          ::Type Q6;
 
   int n;
   std::cout << "    Input:";
@@ -51,77 +104,21 @@ int main(int argc, char* argv[])
   std::cout << '\n';
   ifs.close();
 
-  std::cout << "Q1.Dump(): ";
-  Q1.Dump(std::cout, ' ');
-  std::cout << '\n';
-
-  std::cout << "Q3.Dump(): ";
-  Q3.Dump(std::cout, ' ');
-  std::cout << '\n';
-
-  std::cout << "Q4.Dump(): ";
-  Q4.Dump(std::cout, ' ');
-  std::cout << '\n';
-
-  std::cout << "Q2.Dump(): ";
-  Q2.Dump(std::cout, ' ');
-  std::cout << '\n';
-
-  std::cout << "Q5.Dump(): ";
-  Q5.Dump(std::cout, ' ');
-  std::cout << '\n';
-
-  std::cout << "Q6.Dump(): ";
-  Q6.Dump(std::cout, ' ');
-  std::cout << '\n';
-
-  std::cout << "Q1 Output:";
-  while (!Q1.Empty())
-  {
-    std::cout << ' ' << Q1.Front();
-    Q1.Pop();
-  }
-  std::cout << '\n';
-
-  std::cout << "Q2 Output:";
-  while (!Q2.Empty())
-  {
-    std::cout << ' ' << Q2.Front();
-    Q2.Pop();
-  }
-  std::cout << '\n';
-
-  std::cout << "Q3 Output:";
-  while (!Q3.Empty())
-  {
-    std::cout << ' ' << Q3.Front();
-    Q3.Pop();
-  }
-  std::cout << '\n';
-
-  std::cout << "Q4 Output:";
-  while (!Q4.Empty())
-  {
-    std::cout << ' ' << Q4.Front();
-    Q4.Pop();
-  }
-  std::cout << '\n';
-
-  std::cout << "Q5 Output:";
-  while (!Q5.Empty())
-  {
-    std::cout << ' ' << Q5.Front();
-    Q5.Pop();
-  }
-  std::cout << '\n';
-
-  std::cout << "Q6 Output:";
-  while (!Q6.Empty())
-  {
-    std::cout << ' ' << Q6.Front();
-    Q6.Pop();
-  }
-  std::cout << '\n';
+  Dump("Q1", Q1);
+  Dump("Q3", Q3);
+  Dump("Q4", Q4);
+  Dump("Q2", Q2);
+  Dump("Q5", Q5);
+  Dump("Q6", Q6);
+
+  Drain("Q1", Q1);
+  Drain("Q2", Q2);
+  Drain("Q3", Q3);
+  Drain("Q4", Q4);
+  Drain("Q5", Q5);
+  Drain("Q6", Q6);
+
+  PopMinTies();
 
   return 0;
 }
@@ -19,6 +19,13 @@
 #include <xstring.cpp> // in lieu of makefile
 
 #include <pq.h>
+#include <pqpolicy.h>
+
+// The implementation is chosen with PQ_POLICY (see pqpolicy.h); the
+// makefile builds pqsorttest1.x .. pqsorttest6.x from this file.
+#ifndef PQ_POLICY
+#define PQ_POLICY pqp::UnorderedList
+#endif
 
 int main(int argc, char* argv[])
 {
@@ -36,12 +43,7 @@ int main(int argc, char* argv[])
     exit (EXIT_SUCCESS);
   }
 
-  pq1::PriorityQueue < int , fsu::GreaterThan < int > > Q;
-  // pq2::PriorityQueue < int , fsu::GreaterThan < int > > Q;
-  // pq3::PriorityQueue < int , fsu::GreaterThan < int > > Q;
-  // pq4::PriorityQueue < int , fsu::GreaterThan < int > > Q;
-  // pq5::PriorityQueue < int , fsu::GreaterThan < int > > Q;
-  // pq6::PriorityQueue < int , fsu::GreaterThan < int > > Q;
+  pqp::PriorityQueue < int , fsu::GreaterThan < int > , PQ_POLICY > Q;
 
   int n;
   std::cout << "   Input:";
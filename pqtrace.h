@@ -0,0 +1,165 @@
+/*
+  pqtrace.h
+
+  pqt::Command, pqt::Writer, pqt::Reader
+
+  A compact binary form of the fpq command language (see fpq.cpp and
+  fpq.com1), so that the queue operations of a real run can be captured
+  and replayed offline against every implementation.
+
+  A trace is the 4-byte magic "PQT1" followed by one record per command.
+  A record is the command character itself ('+', '-', 'F', 'C', 'E', 'S',
+  'D'); a push record continues with the priority, 4 bytes little-endian
+  two's complement, and the name: a 2-byte little-endian length and that
+  many bytes. Nothing else is stored, so a pop costs one byte. A name
+  longer than 65535 bytes cannot be stored: Write refuses the command and
+  returns false.
+
+  The text form is the fpq command file: one command per line, a push as
+  "+ name priority". ReadText accepts everything fpq.cpp accepts in batch
+  mode (1 and 2 for + and -, lower case letters) and skips the commands
+  that do not touch the queue (M, X); Q ends the input. WriteText writes
+  the canonical form, so text -> binary -> text reproduces a canonical
+  command file exactly.
+
+    pqt::Writer w(ofs);   w.Write(c);      // record
+    pqt::Reader r(ifs);   r.Read(c);       // replay: false at the end
+*/
+
+#ifndef _PQTRACE_H
+#define _PQTRACE_H
+
+#include <iostream>
+#include <string>
+#include <cstring>     // std::strchr()
+
+namespace pqt
+{
+ struct Command
+ {
+  char        op_;         // '+' '-' 'F' 'C' 'E' 'S' 'D'
+  long        priority_;   // '+' only
+  std::string name_;       // '+' only
+
+  Command() : op_('\0'), priority_(0), name_()
+  {}
+ };
+
+ inline bool ReadText (std::istream& is, Command& c)
+ // next queue command of a text command file; false at Q or end of input,
+ // with c.op_ == '\0', or at a push whose name or priority cannot be read,
+ // with c.op_ == '+'
+ {
+   c.op_ = '\0';
+   char option;
+   while (is >> option)
+   {
+     switch (option)
+     {
+       case '+': case '1':
+         c.op_ = '+';
+         is >> c.name_ >> c.priority_;
+         return !is.fail();
+       case '-': case '2':  c.op_ = '-'; return true;
+       case 'f': case 'F':  c.op_ = 'F'; return true;
+       case 'c': case 'C':  c.op_ = 'C'; return true;
+       case 'e': case 'E':  c.op_ = 'E'; return true;
+       case 's': case 'S':  c.op_ = 'S'; return true;
+       case 'd': case 'D':  c.op_ = 'D'; return true;
+       case 'q': case 'Q':  return false;
+       default:             break;     // M, X: no queue operation
+     }
+   }
+   return false;
+ }
+
+ inline void WriteText (std::ostream& os, const Command& c)
+ {
+   os << c.op_;
+   if (c.op_ == '+')
+     os << ' ' << c.name_ << ' ' << c.priority_;
+   os << '\n';
+ }
+
+ class Writer
+ {
+ public:
+  explicit Writer(std::ostream& os) : os_(&os)
+  {
+    os_->write("PQT1", 4);
+  }
+
+  bool Write (const Command& c)
+  // false, and nothing written, for a name too long for its 2-byte length
+  {
+    size_t n = c.name_.size();
+    if (c.op_ == '+' && n > 0xFFFF) return false;
+    os_->put(c.op_);
+    if (c.op_ != '+') return true;
+    unsigned long p = static_cast<unsigned long>(c.priority_);
+    char b[6];
+    for (size_t i = 0; i < 4; ++i)
+      b[i] = static_cast<char>((p >> (8 * i)) & 0xFF);
+    b[4] = static_cast<char>(n & 0xFF);
+    b[5] = static_cast<char>(n >> 8);
+    os_->write(b, 6);
+    os_->write(c.name_.data(), n);
+    return true;
+  }
+
+  bool Good () const
+  {
+    return os_->good();
+  }
+
+ private:
+  std::ostream* os_;
+ };
+
+ class Reader
+ {
+ public:
+  explicit Reader(std::istream& is) : is_(&is), good_(false)
+  {
+    char magic[4];
+    good_ = is_->read(magic, 4) && magic[0] == 'P' && magic[1] == 'Q'
+            && magic[2] == 'T' && magic[3] == '1';
+  }
+
+  bool Good () const
+  // the input is a trace, and no bad record has been read from it
+  {
+    return good_;
+  }
+
+  bool Read (Command& c)
+  // next record; false at the end of the trace, or on a bad record, which
+  // also turns Good() false: a command character other than those of
+  // Command, or a push record cut short
+  {
+    if (!good_) return false;
+    int op = is_->get();
+    if (op == std::char_traits<char>::eof()) return false;
+    c.op_ = static_cast<char>(op);
+    if (c.op_ == '\0' || std::strchr("+-FCESD", c.op_) == 0)
+      return good_ = false;
+    if (c.op_ != '+') return true;
+    unsigned char b[6];
+    if (!is_->read(reinterpret_cast<char*>(b), 6)) return good_ = false;
+    unsigned long p = 0;
+    for (size_t i = 0; i < 4; ++i)
+      p |= static_cast<unsigned long>(b[i]) << (8 * i);
+    c.priority_ = (p & 0x80000000UL) ? static_cast<long>(p) - 0x100000000L : static_cast<long>(p);
+    size_t n = b[4] | (static_cast<size_t>(b[5]) << 8);
+    c.name_.resize(n);
+    if (n > 0 && !is_->read(&c.name_[0], n)) return good_ = false;
+    return true;
+  }
+
+ private:
+  std::istream* is_;
+  bool          good_;
+ };
+} // namespace pqt
+
+#endif
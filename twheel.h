@@ -0,0 +1,235 @@
+/*
+  twheel.h
+
+  tw::TimingWheel < T , B , L >
+
+  A hierarchical timing wheel for deadline-keyed items: L levels of 2^B
+  slots each. Level l slot s holds the items whose deadline agrees with the
+  current time in every digit above digit l (digits are B bits wide) and
+  has digit l equal to s. Items further out than the whole wheel (2^(B*L)
+  ticks) wait in an overflow list.
+
+  Operations
+  ----------
+     Handle Schedule(deadline, t)    O(1)
+     bool   Cancel(handle)           O(1)
+     void   Advance(now, callback)   O(1) per tick + O(1) per item moved or fired
+
+  Advance(now, f) moves the wheel forward one tick at a time up to now and
+  calls f(t) for every item whose deadline has been reached. When the low
+  digits of the time wrap to zero, the slot of the next level for the new
+  time is "cascaded": its items are re-placed relative to the new time,
+  which puts them on a lower level. A deadline that is not in the future
+  fires on the next tick.
+
+  Items live in a node pool and slots are doubly linked lists of pool
+  indices, so Cancel unlinks in O(1) and nothing is allocated per timer once
+  the pool has grown to the peak number of pending timers. A Handle carries
+  the generation of its node; cancelling a timer that already fired, was
+  already cancelled or was dropped by Clear() is detected and returns false.
+
+  Callbacks may Schedule and Cancel.
+
+  Compare with a pq6 heap of deadlines, where Schedule/expire cost O(log n)
+  and cancellation is usually done lazily, leaving dead timers in the heap
+  until they reach the root.
+*/
+
+#ifndef _TWHEEL_H
+#define _TWHEEL_H
+
+#include <cstddef>
+#include <vector.h>    // fsu::Vector<>
+
+namespace tw
+{
+ typedef unsigned long long Tick;
+
+ template <typename T, size_t B = 6, size_t L = 4>
+ class TimingWheel
+ {
+  static const size_t S   = size_t(1) << B;   // slots per level
+  static const size_t M   = S - 1;            // digit mask
+  static const size_t OVF = L * S;            // index of the overflow list
+  static const size_t NIL = ~size_t(0);
+
+  static_assert(B > 0 && B * L < 64, "tw::TimingWheel: the wheel must span fewer than 2^64 ticks");
+
+  struct Node
+  {
+    T        item_;
+    Tick     deadline_;
+    size_t   prev_, next_;   // list links; next_ also links the free list
+    size_t   slot_;          // owning list, NIL when free
+    unsigned gen_;
+    Node() : item_(), deadline_(0), prev_(NIL), next_(NIL), slot_(NIL), gen_(0) {}
+  };
+
+ public:
+  class Handle
+  {
+    friend class TimingWheel;
+    size_t   index_;
+    unsigned gen_;
+  public:
+    Handle() : index_(NIL), gen_(0) {}
+  };
+
+  TimingWheel() : now_(0), size_(0), free_(NIL)
+  {
+    for (size_t s = 0; s <= OVF; ++s) head_[s] = NIL;
+  }
+
+  explicit TimingWheel(Tick now) : now_(now), size_(0), free_(NIL)
+  {
+    for (size_t s = 0; s <= OVF; ++s) head_[s] = NIL;
+  }
+
+  Handle Schedule (Tick deadline, const T& t)
+  {
+    size_t i;
+    if (free_ != NIL)
+    {
+      i = free_;
+      free_ = n_[i].next_;
+    }
+    else
+    {
+      i = n_.Size();
+      n_.PushBack(Node());
+    }
+    n_[i].item_ = t;
+    n_[i].deadline_ = (deadline > now_) ? deadline : now_ + 1;
+    Place(i);
+    ++size_;
+    Handle h;
+    h.index_ = i;
+    h.gen_ = n_[i].gen_;
+    return h;
+  }
+
+  bool Cancel (const Handle& h)
+  {
+    if (h.index_ >= n_.Size() || n_[h.index_].gen_ != h.gen_ || n_[h.index_].slot_ == NIL)
+      return false;
+    Unlink(h.index_);
+    Release(h.index_);
+    --size_;
+    return true;
+  }
+
+  template <class F>
+  void Advance (Tick now, F callback)
+  {
+    while (now_ < now)
+    {
+      if (size_ == 0)
+      {
+        now_ = now;
+        break;
+      }
+      ++now_;
+
+      // cascade from the highest level whose lower digits just wrapped
+      size_t l = 0;
+      while (l < L && ((now_ >> (B * l)) & M) == 0) ++l;
+      if (l == L)
+        Cascade(OVF);
+      for (; l > 0; --l)
+        if (l < L) Cascade((l * S) + ((now_ >> (B * l)) & M));
+
+      // fire level 0; re-read the head each time so callbacks may Cancel
+      size_t s = now_ & M;
+      while (head_[s] != NIL)
+      {
+        size_t i = head_[s];
+        Unlink(i);
+        T t = n_[i].item_;
+        Release(i);
+        --size_;
+        callback(t);
+      }
+    }
+  }
+
+  void Clear ()
+  // the pool is kept: every node goes back on the free list, the pending
+  // ones with a new generation, so that their handles no longer Cancel
+  {
+    for (size_t s = 0; s <= OVF; ++s) head_[s] = NIL;
+    free_ = NIL;
+    for (size_t i = n_.Size(); i-- > 0; )
+    {
+      if (n_[i].slot_ != NIL)
+      {
+        n_[i].slot_ = NIL;
+        ++n_[i].gen_;
+      }
+      n_[i].next_ = free_;
+      free_ = i;
+    }
+    size_ = 0;
+  }
+
+  bool   Empty () const { return size_ == 0; }
+  size_t Size  () const { return size_; }
+  Tick   Now   () const { return now_; }
+
+ private:
+  fsu::Vector < Node > n_;
+  size_t head_[OVF + 1];
+  Tick   now_;
+  size_t size_;
+  size_t free_;
+
+  void Place (size_t i)
+  // level = highest digit in which deadline and now_ differ
+  {
+    Tick d = n_[i].deadline_;
+    size_t s = OVF;
+    for (size_t l = 0; l < L; ++l)
+    {
+      if ((d >> (B * (l + 1))) == (now_ >> (B * (l + 1))))
+      {
+        s = l * S + ((d >> (B * l)) & M);
+        break;
+      }
+    }
+    n_[i].slot_ = s;
+    n_[i].prev_ = NIL;
+    n_[i].next_ = head_[s];
+    if (head_[s] != NIL) n_[head_[s]].prev_ = i;
+    head_[s] = i;
+  }
+
+  void Unlink (size_t i)
+  {
+    Node& n = n_[i];
+    if (n.prev_ != NIL) n_[n.prev_].next_ = n.next_;
+    else                head_[n.slot_]    = n.next_;
+    if (n.next_ != NIL) n_[n.next_].prev_ = n.prev_;
+    n.slot_ = NIL;
+  }
+
+  void Release (size_t i)
+  {
+    ++n_[i].gen_;
+    n_[i].next_ = free_;
+    free_ = i;
+  }
+
+  void Cascade (size_t s)
+  {
+    size_t i = head_[s];
+    head_[s] = NIL;
+    while (i != NIL)
+    {
+      size_t next = n_[i].next_;
+      Place(i);
+      i = next;
+    }
+  }
+ };
+} // namespace tw
+
+#endif